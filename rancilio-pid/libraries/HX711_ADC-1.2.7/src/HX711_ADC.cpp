@@ -232,7 +232,7 @@ float HX711_ADC::getCalFactor()
 //if conversion is ready; read out 24 bit data and add to dataset, returns 1
 //if tare operation is complete, returns 2
 //else returns 0
-uint8_t HX711_ADC::update() 
+uint8_t HX711_ISR_ATTR HX711_ADC::update() 
 {
 	byte dout = digitalRead(doutPin); //check if conversion is ready
 	if (!dout) 
@@ -262,7 +262,7 @@ float HX711_ADC::getData() // return fresh data from the moving average dataset
 	return x;
 }
 
-long HX711_ADC::smoothedData() 
+long HX711_ISR_ATTR HX711_ADC::smoothedData() 
 {
 	long data = 0;
 	long L = 0xFFFFFF;
@@ -288,7 +288,7 @@ long HX711_ADC::smoothedData()
 
 }
 
-void HX711_ADC::conversion24bit()  //read 24 bit data, store in dataset and start the next conversion
+void HX711_ISR_ATTR HX711_ADC::conversion24bit()  //read 24 bit data, store in dataset and start the next conversion
 {
 	conversionTime = micros() - conversionStartTime;
 	conversionStartTime = micros();
@@ -333,6 +333,7 @@ void HX711_ADC::conversion24bit()  //read 24 bit data, store in dataset and star
 	{
 		convRslt++;
 		dataSampleSet[readIndex] = (long)data;
+		sampleCount++;
 		if(doTare) 
 		{
 			if (tareTimes < DATA_SET) 
@@ -504,3 +505,15 @@ bool HX711_ADC::getSignalTimeoutFlag()
 {
 	return signalTimeoutFlag;
 }
+
+//conversions added to the dataset so far, changes when getData() has something new
+unsigned long HX711_ADC::getSampleCount()
+{
+	return sampleCount;
+}
+
+//micros() of the last conversion read out
+unsigned long HX711_ADC::getSampleTime()
+{
+	return conversionStartTime;
+}
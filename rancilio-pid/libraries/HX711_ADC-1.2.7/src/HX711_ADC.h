@@ -82,6 +82,8 @@ class HX711_ADC
 		bool getDataSetStatus();					//returns 'true' when the whole dataset has been filled up with conversions, i.e. after a reset/restart
 		float getNewCalibration(float known_mass);	//returns and sets a new calibration value (calFactor) based on a known mass input
 		bool getSignalTimeoutFlag();				//returns 'true' if it takes longer time then 'SIGNAL_TIMEOUT' for the dout pin to go low after a new conversion is started
+		unsigned long getSampleCount();				//conversions added to the dataset so far, changes when getData() has something new
+		unsigned long getSampleTime();				//micros() of the last conversion read out
 
 	protected:
 		void conversion24bit(); 					//if conversion is ready: returns 24 bit data and starts the next conversion
@@ -94,7 +96,8 @@ class HX711_ADC
 		volatile long dataSampleSet[DATA_SET + 1];	// dataset, make voltile if interrupt is used 
 		long tareOffset;
 		int readIndex = 0;
-		unsigned long conversionStartTime;
+		volatile unsigned long conversionStartTime;
+		volatile unsigned long sampleCount = 0;
 		unsigned long conversionTime;
 		uint8_t isFirst = 1;
 		uint8_t tareTimes;
@@ -35,6 +35,16 @@ Note that you can also overide (reducing) the number of samples in use at any ti
 //Change the value to '1' to enable the delay.
 #define SCK_DELAY					0		//default value: 0
 
+//rancilio-pid: update() may run from a DOUT falling edge interrupt (attachInterrupt), so it and
+//the functions it calls are placed in IRAM on the ESP8266/ESP32
+#if defined(ESP8266)
+#define HX711_ISR_ATTR				ICACHE_RAM_ATTR
+#elif defined(ESP32)
+#define HX711_ISR_ATTR				IRAM_ATTR
+#else
+#define HX711_ISR_ATTR
+#endif
+
 //if you have some other time consuming (>60μs) interrupt routines that trigger while the sck pin is high, this could unintentionally set the HX711 into "power down" mode
 //if required you can change the value to '1' to disable interrupts when writing to the sck pin.
 #define SCK_DISABLE_INTERRUPTS		0		//default value: 0
@@ -0,0 +1,285 @@
+/**********************************************************************************************
+ * Fixed-point PID, drop-in replacement for the Arduino PID Library v1.2.1
+ * Algorithm and interface by Brett Beauregard <br3ttb@gmail.com> brettbeauregard.com
+ *
+ * This Library is licensed under the MIT License
+ **********************************************************************************************/
+
+#if ARDUINO >= 100
+  #include "Arduino.h"
+#else
+  #include "WProgram.h"
+#endif
+
+#include <string.h>
+#include <PID_fixed.h>
+
+#define Q16_ONE   65536.0
+#define Q24_ONE   16777216.0
+
+/* Fixed-point arithmetic ***************************************************
+ *    All helpers saturate instead of wrapping around, like the floating point
+ *    version does not wrap around either.
+ ***************************************************************************/
+static inline int32_t saturate(int64_t value)
+{
+   if(value > INT32_MAX) return INT32_MAX;
+   if(value < -INT32_MAX) return -INT32_MAX;
+   return (int32_t)value;
+}
+
+static inline int32_t mulQ16(int32_t gain, int32_t value)
+{
+   return saturate(((int64_t)gain * value + (1 << 15)) >> 16);
+}
+
+static inline int32_t mulQ24(int32_t gain, int32_t value)
+{
+   return saturate(((int64_t)gain * value + (1 << 23)) >> 24);
+}
+
+static int32_t gainToFixed(double gain, double one)
+{
+   double scaled = gain * one;
+   if(scaled >= INT32_MAX) return INT32_MAX;
+   if(scaled <= -INT32_MAX) return -INT32_MAX;
+   return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+/* toFixed(...) ***************************************************************
+ *    double -> Q16.16 by taking the IEEE 754 representation apart, so no
+ *    soft-float library call is needed. Rounds to nearest, saturates, NaN -> 0.
+ ******************************************************************************/
+int32_t PIDFixed::toFixed(double value)
+{
+   uint64_t bits;
+   memcpy(&bits, &value, sizeof(bits));
+
+   int exponent = (int)((bits >> 52) & 0x7FF);
+   bool negative = (bits >> 63) != 0;
+   if(exponent == 0x7FF && (bits & 0xFFFFFFFFFFFFFULL)) return 0;    // NaN
+
+   /* value = mantissa * 2^(exponent-1075), Q16.16 = value * 2^16 */
+   int shift = 1059 - exponent;
+   if(shift <= 21) return negative ? -INT32_MAX : INT32_MAX;          // |value| >= 32768
+   if(shift > 53) return 0;                                           // |value| < 2^-17
+
+   uint64_t mantissa = (bits & 0xFFFFFFFFFFFFFULL) | (1ULL << 52);
+   uint64_t magnitude = (mantissa + (1ULL << (shift - 1))) >> shift;
+   int32_t result = magnitude > INT32_MAX ? INT32_MAX : (int32_t)magnitude;
+   return negative ? -result : result;
+}
+
+/* fromFixed(...) *************************************************************
+ *    Q16.16 -> double, exact, by building the IEEE 754 representation.
+ ******************************************************************************/
+double PIDFixed::fromFixed(int32_t value)
+{
+   if(value == 0) return 0.0;
+
+   uint64_t sign = value < 0 ? 1 : 0;
+   uint32_t magnitude = value < 0 ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+   int msb = 31 - __builtin_clz(magnitude);
+
+   uint64_t bits = (sign << 63)
+                 | ((uint64_t)(msb - 16 + 1023) << 52)
+                 | (((uint64_t)magnitude << (52 - msb)) & 0xFFFFFFFFFFFFFULL);
+   double result;
+   memcpy(&result, &bits, sizeof(result));
+   return result;
+}
+
+/*Constructor (...)*********************************************************
+ *    The parameters specified here are those for for which we can't set up
+ *    reliable defaults, so we need to have the user set them.
+ ***************************************************************************/
+PIDFixed::PIDFixed(double* Input, double* Output, double* Setpoint,
+        double Kp, double Ki, double Kd, int POn, int ControllerDirection)
+{
+    myOutput = Output;
+    myInput = Input;
+    mySetpoint = Setpoint;
+    inAuto = false;
+    outputSum = 0;
+    lastInput = 0;
+
+    PIDFixed::SetOutputLimits(0, 255);			//default output limit corresponds to
+												//the arduino pwm limits
+
+    SampleTime = 100;							//default Controller Sample Time is 0.1 seconds
+
+    PIDFixed::SetControllerDirection(ControllerDirection);
+    PIDFixed::SetTunings(Kp, Ki, Kd, POn);
+
+    lastTime = millis()-SampleTime;
+}
+
+/*Constructor (...)*********************************************************
+ *    Proportional on Error without explicitly saying so
+ ***************************************************************************/
+PIDFixed::PIDFixed(double* Input, double* Output, double* Setpoint,
+        double Kp, double Ki, double Kd, int ControllerDirection)
+    :PIDFixed::PIDFixed(Input, Output, Setpoint, Kp, Ki, Kd, P_ON_E, ControllerDirection)
+{
+
+}
+
+
+/* Compute() **********************************************************************
+ *     Same as PID_v1::Compute(), integer arithmetic only. Cheap enough to be called
+ *   from an ISR. Returns true when the output is computed, false when nothing has
+ *   been done.
+ **********************************************************************************/
+bool PIDFixed::Compute()
+{
+   if(!inAuto) return false;
+   unsigned long now = millis();
+   unsigned long timeChange = (now - lastTime);
+   if(timeChange>=SampleTime)
+   {
+      /*Compute all the working error variables*/
+      int32_t input = toFixed(*myInput);
+      int32_t error = saturate((int64_t)toFixed(*mySetpoint) - input);
+      int32_t dInput = saturate((int64_t)input - lastInput);
+      int64_t sum = (int64_t)outputSum + mulQ24(ki, error);
+
+      /*Add Proportional on Measurement, if P_ON_M is specified*/
+      if(!pOnE) sum -= mulQ16(kp, dInput);
+
+      if(sum > outMax) sum = outMax;
+      else if(sum < outMin) sum = outMin;
+      outputSum = (int32_t)sum;
+
+      /*Add Proportional on Error, if P_ON_E is specified*/
+      int64_t output;
+      if(pOnE) output = mulQ16(kp, error);
+      else output = 0;
+
+      /*Compute Rest of PID Output*/
+      output += (int64_t)outputSum - mulQ16(kd, dInput);
+
+      if(output > outMax) output = outMax;
+      else if(output < outMin) output = outMin;
+      *myOutput = fromFixed((int32_t)output);
+
+      /*Remember some variables for next time*/
+      lastInput = input;
+      lastTime = now;
+      return true;
+   }
+   else return false;
+}
+
+/* SetTunings(...)*************************************************************
+ * This function allows the controller's dynamic performance to be adjusted.
+ * it's called automatically from the constructor, but tunings can also
+ * be adjusted on the fly during normal operation
+ ******************************************************************************/
+void PIDFixed::SetTunings(double Kp, double Ki, double Kd, int POn)
+{
+   if (Kp<0 || Ki<0 || Kd<0) return;
+
+   pOn = POn;
+   pOnE = POn == P_ON_E;
+
+   dispKp = Kp; dispKi = Ki; dispKd = Kd;
+
+   ScaleTunings();
+}
+
+/* SetTunings(...)*************************************************************
+ * Set Tunings using the last-rembered POn setting
+ ******************************************************************************/
+void PIDFixed::SetTunings(double Kp, double Ki, double Kd){
+    SetTunings(Kp, Ki, Kd, pOn);
+}
+
+/* ScaleTunings() *************************************************************
+ * Converts the user-entered tunings to per-sample fixed-point gains. Called
+ * whenever the tunings, the sample time or the direction change.
+ ******************************************************************************/
+void PIDFixed::ScaleTunings()
+{
+   double SampleTimeInSec = ((double)SampleTime)/1000;
+   double sign = controllerDirection == REVERSE ? -1 : 1;
+
+   kp = gainToFixed(sign * dispKp, Q16_ONE);
+   ki = gainToFixed(sign * dispKi * SampleTimeInSec, Q24_ONE);
+   kd = gainToFixed(sign * dispKd / SampleTimeInSec, Q16_ONE);
+}
+
+/* SetSampleTime(...) *********************************************************
+ * sets the period, in Milliseconds, at which the calculation is performed
+ ******************************************************************************/
+void PIDFixed::SetSampleTime(int NewSampleTime)
+{
+   if (NewSampleTime > 0)
+   {
+      SampleTime = (unsigned long)NewSampleTime;
+      ScaleTunings();
+   }
+}
+
+/* SetOutputLimits(...)****************************************************
+ *     Clamps the output (and the integral term) to [Min, Max].
+ **************************************************************************/
+void PIDFixed::SetOutputLimits(double Min, double Max)
+{
+   if(Min >= Max) return;
+   outMin = toFixed(Min);
+   outMax = toFixed(Max);
+
+   if(inAuto)
+   {
+	   if(*myOutput > Max) *myOutput = Max;
+	   else if(*myOutput < Min) *myOutput = Min;
+
+	   if(outputSum > outMax) outputSum= outMax;
+	   else if(outputSum < outMin) outputSum= outMin;
+   }
+}
+
+/* SetMode(...)****************************************************************
+ * Allows the controller Mode to be set to manual (0) or Automatic (non-zero)
+ * when the transition from manual to auto occurs, the controller is
+ * automatically initialized
+ ******************************************************************************/
+void PIDFixed::SetMode(int Mode)
+{
+    bool newAuto = (Mode == AUTOMATIC);
+    if(newAuto && !inAuto)
+    {  /*we just went from manual to auto*/
+        PIDFixed::Initialize();
+    }
+    inAuto = newAuto;
+}
+
+/* Initialize()****************************************************************
+ *	does all the things that need to happen to ensure a bumpless transfer
+ *  from manual to automatic mode.
+ ******************************************************************************/
+void PIDFixed::Initialize()
+{
+   outputSum = toFixed(*myOutput);
+   lastInput = toFixed(*myInput);
+   if(outputSum > outMax) outputSum = outMax;
+   else if(outputSum < outMin) outputSum = outMin;
+}
+
+/* SetControllerDirection(...)*************************************************
+ * DIRECT (+Output leads to +Input) or REVERSE (+Output leads to -Input)
+ ******************************************************************************/
+void PIDFixed::SetControllerDirection(int Direction)
+{
+   controllerDirection = Direction;
+   ScaleTunings();
+}
+
+/* Status Funcions*************************************************************
+ * These functions query the internal state of the PID, in user-entered format.
+ ******************************************************************************/
+double PIDFixed::GetKp(){ return  dispKp; }
+double PIDFixed::GetKi(){ return  dispKi;}
+double PIDFixed::GetKd(){ return  dispKd;}
+int PIDFixed::GetMode(){ return  inAuto ? AUTOMATIC : MANUAL;}
+int PIDFixed::GetDirection(){ return controllerDirection;}
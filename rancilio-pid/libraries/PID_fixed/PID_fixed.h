@@ -0,0 +1,105 @@
+#ifndef PID_fixed_h
+#define PID_fixed_h
+#define PID_FIXED_LIBRARY_VERSION	1.0.0
+
+#include <stdint.h>
+
+/**********************************************************************************************
+ * Fixed-point PID, drop-in replacement for the Arduino PID Library v1.2.1 (PID_v1)
+ *
+ * Same interface and same algorithm as PID_v1 (proportional on error or on measurement,
+ * integral clamping, derivative on measurement), but Compute() only uses integer
+ * arithmetic. On MCUs without FPU (ESP8266) every double operation is a soft-float
+ * library call, which makes PID_v1::Compute() expensive inside an interrupt.
+ *
+ * Number formats (all int32_t):
+ *   input, setpoint, output, integral   Q16.16   range +/-32767, resolution 1.5e-5
+ *   kp, kd (per sample)                 Q16.16
+ *   ki (per sample)                     Q8.24    range +/-127,   resolution 6e-8
+ * Tunings outside these ranges are saturated. The linked Input/Output/Setpoint doubles
+ * are converted with integer bit manipulation, so Compute() never calls the soft-float
+ * library.
+ **********************************************************************************************/
+class PIDFixed
+{
+
+
+  public:
+
+  //Constants used in some of the functions below (same values as PID_v1)
+  #ifndef AUTOMATIC
+  #define AUTOMATIC	1
+  #define MANUAL	0
+  #define DIRECT  0
+  #define REVERSE  1
+  #define P_ON_M 0
+  #define P_ON_E 1
+  #endif
+
+  //commonly used functions **************************************************************************
+    PIDFixed(double*, double*, double*,   // * constructor.  links the PID to the Input, Output, and
+        double, double, double, int, int);//   Setpoint.  Initial tuning parameters are also set here.
+                                          //   (overload for specifying proportional mode)
+
+    PIDFixed(double*, double*, double*,   // * constructor.  links the PID to the Input, Output, and
+        double, double, double, int);     //   Setpoint.  Initial tuning parameters are also set here
+
+    void SetMode(int Mode);               // * sets PID to either Manual (0) or Auto (non-0)
+
+    bool Compute();                       // * performs the PID calculation, integer only.
+                                          //   returns true when the output was computed
+
+    void SetOutputLimits(double, double); // * clamps the output to a specific range. 0-255 by default
+
+
+
+  //available but not commonly used functions ********************************************************
+    void SetTunings(double, double,       // * changes the tunings during runtime
+                    double);
+    void SetTunings(double, double,       // * overload for specifying proportional mode
+                    double, int);
+
+    void SetControllerDirection(int);     // * Sets the Direction, DIRECT or REVERSE
+    void SetSampleTime(int);              // * sets the frequency, in Milliseconds, with which
+                                          //   the PID calculation is performed.  default is 100
+
+
+
+  //Display functions ****************************************************************
+    double GetKp();                       // These functions query the pid for interal values.
+    double GetKi();                       //  they return the tunings in user-entered format
+    double GetKd();                       //
+    int GetMode();                        //
+    int GetDirection();                   //
+
+  //Fixed-point helpers, public for benchmarks and for callers with fixed-point data ***********
+    static int32_t toFixed(double);       // * double -> Q16.16 (saturating), integer only
+    static double fromFixed(int32_t);     // * Q16.16 -> double, integer only
+
+  private:
+    void Initialize();
+    void ScaleTunings();
+
+    double dispKp;                // * we'll hold on to the tuning parameters in user-entered
+    double dispKi;                //   format for display purposes
+    double dispKd;                //
+
+    int32_t kp;                   // * (P)roportional Tuning Parameter, Q16.16
+    int32_t ki;                   // * (I)ntegral Tuning Parameter per sample, Q8.24
+    int32_t kd;                   // * (D)erivative Tuning Parameter per sample, Q16.16
+
+    int controllerDirection;
+    int pOn;
+
+    double *myInput;              // * Pointers to the Input, Output, and Setpoint variables
+    double *myOutput;             //
+    double *mySetpoint;           //
+
+    unsigned long lastTime;
+    int32_t outputSum, lastInput; // Q16.16
+
+    unsigned long SampleTime;
+    int32_t outMin, outMax;       // Q16.16
+    bool inAuto, pOnE;
+};
+#endif
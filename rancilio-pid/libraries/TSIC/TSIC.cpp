@@ -55,7 +55,8 @@
 
 // Initialize inputs/outputs
 TSIC::TSIC(uint8_t signal_pin, uint8_t vcc_pin, uint8_t sens_type)
-	: m_signal_pin(signal_pin), m_vcc_pin(vcc_pin), m_sens_type(sens_type)
+	: m_signal_pin(signal_pin), m_vcc_pin(vcc_pin), m_sens_type(sens_type),
+	  m_frame_us(0), m_period_us(0), m_misses(0)
 {
     if(m_vcc_pin!=NO_VCC_PIN) pinMode(m_vcc_pin, OUTPUT);
     pinMode(m_signal_pin, INPUT);
@@ -63,12 +64,51 @@ TSIC::TSIC(uint8_t signal_pin, uint8_t vcc_pin, uint8_t sens_type)
 
 // read temperature
 uint8_t TSIC::getTemperature(uint16_t *temp_value16){
+		if(m_vcc_pin!=NO_VCC_PIN) TSIC_ON();
+		delayMicroseconds(50);     // wait for stabilization
+		return readFrame(temp_value16, 10000);
+}
+
+/*	Read only if the next frame is due: the first call reads two frames in
+	a row (blocking) for the frame period, after that a call returns at once
+	unless the next frame starts within TSIC_SYNC_WINDOW_US. The period is
+	tracked with every frame, after TSIC_SYNC_MISSES missed frames it is
+	learned again.
+*/
+uint8_t TSIC::pollTemperature(uint16_t *temp_value16){
+		if(m_vcc_pin!=NO_VCC_PIN) return getTemperature(temp_value16);	// frames start at power on
+
+		if (m_period_us == 0) {
+			if (!readFrame(temp_value16, 10000)) return 0;
+			uint32_t first = m_frame_us;
+			if (!readFrame(temp_value16, 10000)) return 0;
+			m_period_us = m_frame_us - first;
+			m_misses = 0;
+			return 1;
+		}
+
+		uint32_t lastFrame = m_frame_us;
+		uint32_t untilFrame = m_period_us - (micros() - lastFrame) % m_period_us;
+		if (untilFrame > TSIC_SYNC_WINDOW_US) return 0;
+
+		if (!readFrame(temp_value16, (untilFrame + TSIC_SYNC_WINDOW_US) / 10)) {
+			if (++m_misses >= TSIC_SYNC_MISSES) m_period_us = 0;
+			return 0;
+		}
+		m_misses = 0;
+
+		// track the period, n periods since the last frame read
+		uint32_t delta = m_frame_us - lastFrame;
+		uint32_t n = (delta + m_period_us / 2) / m_period_us;
+		if (n > 0) m_period_us = (m_period_us * 7 + delta / n) / 8;
+		return 1;
+}
+
+uint8_t TSIC::readFrame(uint16_t *temp_value16, uint16_t startTimeout){
 		uint16_t temp_value1 = 0;
 		uint16_t temp_value2 = 0;
 
-		if(m_vcc_pin!=NO_VCC_PIN) TSIC_ON();
-		delayMicroseconds(50);     // wait for stabilization
-		if(TSIC::readSens(&temp_value1)){}			// get 1st byte
+		if(TSIC::readSens(&temp_value1, startTimeout, &m_frame_us)){}	// get 1st byte, note the frame start
 		else TSIC_EXIT();
 		if(TSIC::readSens(&temp_value2)){}			// get 2nd byte
 		else TSIC_EXIT();
@@ -103,16 +143,17 @@ float TSIC::calc_Celsius(uint16_t *temperature16){
 	return celsius;
 }
 
-uint8_t TSIC::readSens(uint16_t *temp_value){
+uint8_t TSIC::readSens(uint16_t *temp_value, uint16_t startTimeout, uint32_t *start_us){
 	uint16_t strobelength = 0;
 	uint16_t strobetemp = 0;
 	uint8_t dummy = 0;
-	uint16_t timeout = 0;	// max value for timeout is set in .h file
+	uint16_t timeout = 10000 - startTimeout;	// max value for timeout is set in .h file
 	while (TSIC_HIGH){	// wait until start bit starts
 		timeout++;
 		delayMicroseconds(10);
 		Cancel();
 	}
+	if (start_us) *start_us = micros();
 	// Measure strobe time, a healthy sensor will go to LOW within a few loops (~60us)
 	// if no sensor is connected, the timeout cancels the operation (-> 100cycles are more than enough for this)
 	strobelength = 0;
@@ -2,6 +2,14 @@
 * Library for reading TSIC digital temperature sensors 20x, 30x, 50x
 * using the Arduino platform.
 *
+* rancilio-pid: frame synchronised reading
+*		- pollTemperature() learns the frame period of the sensor (~100ms)
+*		  and only reads when the next frame is about to start, so a
+*		  reading costs the frame itself (~2.7ms) instead of the wait
+*		  for it (up to 100ms); otherwise it returns at once
+*		- for sensors with a permanent supply (NO_VCC_PIN), GPIO16 on the
+*		  ESP8266 has no pin interrupt for an edge decoder
+*
 * Version 2.3 (by Roman Schmitz, 2016-11-01)
 *		- sensor can be operated with external VCC, so no extra pin is neccessary
 *		- standard vcc-pin set to 255 (NO_VCC_PIN)
@@ -68,16 +76,25 @@
 #define TSIC_EXIT()	{TSIC_OFF(); return 0;}
 #define Cancel()	if (timeout > 10000){return 0;}				// Cancel if sensor is disconnected
 
+#define TSIC_SYNC_WINDOW_US	1000		// pollTemperature() reads if the next frame starts within this
+#define TSIC_SYNC_MISSES	3		// missed frames until the period is learned again
+
 class TSIC {
 	public:
 		explicit TSIC(uint8_t signal_pin, uint8_t vcc_pin=NO_VCC_PIN, uint8_t sens_type=TSIC_30x);
 		uint8_t getTemperature(uint16_t *temp_value16);
+		uint8_t pollTemperature(uint16_t *temp_value16);	// 1 = new frame read, 0 = none due (or error)
+		uint32_t framePeriod() { return m_period_us; }		// us, 0 = not synchronised
 		float calc_Celsius(uint16_t *temperature16);
 	private:
 		uint8_t m_signal_pin;
 		uint8_t m_vcc_pin;
 		uint8_t m_sens_type;
-		uint8_t readSens(uint16_t *temp_value);
+		uint32_t m_frame_us;		// start of the last frame read
+		uint32_t m_period_us;		// learned frame period, 0 = unknown
+		uint8_t m_misses;
+		uint8_t readFrame(uint16_t *temp_value16, uint16_t startTimeout);
+		uint8_t readSens(uint16_t *temp_value, uint16_t startTimeout = 10000, uint32_t *start_us = NULL);
 		uint8_t checkParity(uint16_t *temp_value);
 };
 
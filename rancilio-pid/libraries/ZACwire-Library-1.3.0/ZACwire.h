@@ -1,6 +1,10 @@
 /*  ZACwire - Library for reading temperature sensors TSIC 206/306/506
   created by Adrian Immer in 2020
   v1.3.0
+
+  rancilio-pid: the ISR also pushes every complete frame
+  with its capture time into a sample ring, getSample()
+  drains it (about 10 frames per second)
 */
 
 #ifndef ZACwire_h
@@ -68,7 +72,7 @@ class ZACwire {
 		}
 		else if (!misreading) {						//restart with backUP raw temperature
 			misreading = true;
-			getTemp();
+			return getTemp();
 		}
 		else {
 			misreading = false;
@@ -76,6 +80,24 @@ class ZACwire {
 		}
 	}
   
+	bool getSample(float &celsius, unsigned long &capturedUs) {	//oldest frame not read yet, false if there is none
+		if (sampleTail == sampleHead) return false;
+		uint16_t raw = samples[sampleTail].raw;
+		capturedUs = samples[sampleTail].us;
+		sampleTail = (sampleTail + 1) & (sampleSlots - 1);	//frees the slot for the ISR
+
+		if (bitWindow && BitCounter == 19) {		//adjust bitWindow like getTemp() does
+			byte newBitWindow = ((ByteTime << 1) + ByteTime >> 5) + (range >> 1);
+			if (bitWindow < newBitWindow) ++bitWindow;
+			else if (bitWindow > newBitWindow) --bitWindow;
+		}
+		if (_Sensortype < 400) celsius = float((raw * 250L >> 8) - 499) / 10;
+		else celsius = float((raw * 175L >> 9) - 99) / 10;
+		return true;
+	}
+
+	byte samplesLost() { return lostSamples; }		//frames dropped because the ring was full
+  
 	void end() {
 		detachInterrupt(isrPin);
 	}
@@ -121,9 +143,35 @@ class ZACwire {
 			rawTemp[ByteNr][backUP] <<= 1;      
 			if (deltaTime > bitWindow);				//Logic 0
 			else if (rawTemp[ByteNr][backUP] & 2 || deltaTime < bitWindow - (range >> (BitCounter==11))) rawTemp[ByteNr][backUP] |= 1;  //Logic 1
+			if (BitCounter == 19) pushSample(microtime);	//frame complete
 			deltaTime = microtime;
 		}
 	}
+
+	#if defined(ESP32)
+	static void IRAM_ATTR pushSample(unsigned long us) {
+	#elif defined(ESP8266)
+	static void ICACHE_RAM_ATTR pushSample(unsigned long us) {
+	#else
+	static void pushSample(unsigned long us) {
+	#endif
+		uint16_t tempHigh = rawTemp[0][backUP];
+		uint16_t tempLow = rawTemp[1][backUP];
+		byte parity1 = 0, parity2 = 0;
+		for (byte i = 0; i < 9; ++i) {
+			if (tempHigh & 1 << i) ++parity1;
+			if (tempLow & 1 << i) ++parity2;
+		}
+		if (!(tempHigh | tempLow) || (parity1 | parity2) & 1) return;	//parity error
+		byte next = (sampleHead + 1) & (sampleSlots - 1);
+		if (next == sampleTail) {					//full, the reader is too slow
+			++lostSamples;
+			return;
+		}
+		samples[sampleHead].raw = (tempHigh >> 1) << 8 | (tempLow >> 1 & 0xFF);
+		samples[sampleHead].us = us;
+		sampleHead = next;							//publish after the slot is written
+	}
   
     static int isrPin;
     int _Sensortype;								//either 206, 306 or 506
@@ -136,6 +184,17 @@ class ZACwire {
     static const byte range = 62;
     static volatile bool backUP;
     static volatile unsigned int lastISR;
+
+    // single producer (ISR) / single consumer (getSample) ring
+    struct Sample {
+      uint16_t raw;
+      unsigned long us;
+    };
+    static const byte sampleSlots = 8;				//power of two, 7 frames = 0.7 s
+    static volatile Sample samples[sampleSlots];
+    static volatile byte sampleHead;				//written by the ISR only
+    static volatile byte sampleTail;				//written by getSample() only
+    static volatile byte lostSamples;
 };
 
 template<uint8_t pin>
@@ -152,5 +211,13 @@ template<uint8_t pin>
 byte ZACwire<pin>::bitWindow = 0;
 template<uint8_t pin>
 volatile unsigned int ZACwire<pin>::lastISR;
+template<uint8_t pin>
+volatile typename ZACwire<pin>::Sample ZACwire<pin>::samples[ZACwire<pin>::sampleSlots];
+template<uint8_t pin>
+volatile byte ZACwire<pin>::sampleHead = 0;
+template<uint8_t pin>
+volatile byte ZACwire<pin>::sampleTail = 0;
+template<uint8_t pin>
+volatile byte ZACwire<pin>::lostSamples = 0;
 
 #endif
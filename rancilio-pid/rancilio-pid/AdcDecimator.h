@@ -0,0 +1,69 @@
+#ifndef AdcDecimator_h
+#define AdcDecimator_h
+
+#include <stdint.h>
+
+/********************************************************
+  AdcDecimator: oversampled ADC readings to a lower rate
+
+  Second order CIC (cascaded integrator comb) low-pass,
+  the same as a triangular moving average over the last
+  2 * factor readings, computed once per output:
+
+      add():    two integrators, every reading
+      factor-th reading: two combs, value() = comb / factor^2
+
+  The response has zeros at the output rate and all its
+  multiples, so pump pulsation (50/60 Hz) and other
+  ripple at or above the output rate do not alias into
+  value(). Averaging also adds resolution below one LSB
+  (10 bit ADC, factor 20: about 3 bits). The integrators
+  wrap, the comb differences stay exact as long as
+  factor^2 * largest reading < 2^32.
+******************************************************/
+class AdcDecimator
+{
+  public:
+    explicit AdcDecimator(uint16_t factor)
+    {
+      m_factor = factor > 0 ? factor : 1;
+      reset(0);
+    }
+
+    // as if reading had been constant for a long time
+    void reset(int reading)
+    {
+      m_int1 = m_int2 = 0;
+      m_comb1 = m_comb2 = 0;
+      m_count = 0;
+      for (uint16_t i = 0; i < 2 * m_factor; i++) add(reading);
+      m_value = reading;
+    }
+
+    // returns true when value() has a new output
+    bool add(int reading)
+    {
+      m_int1 += (uint32_t)reading;
+      m_int2 += m_int1;
+      if (++m_count < m_factor) return false;
+      m_count = 0;
+
+      uint32_t comb1 = m_int2 - m_comb1;
+      m_comb1 = m_int2;
+      uint32_t comb2 = comb1 - m_comb2;
+      m_comb2 = comb1;
+      m_value = (float)comb2 / ((uint32_t)m_factor * m_factor);
+      return true;
+    }
+
+    float value() const { return m_value; }  // mean reading
+    uint16_t factor() const { return m_factor; }
+
+  private:
+    uint16_t m_factor;
+    uint16_t m_count;
+    uint32_t m_int1, m_int2;
+    uint32_t m_comb1, m_comb2;  // integrator and first comb at the last output
+    float m_value;
+};
+#endif
@@ -0,0 +1,68 @@
+#ifndef AnalogSwitch_h
+#define AnalogSwitch_h
+
+#include <stdint.h>
+
+/********************************************************
+  AnalogSwitch: a switch read through the ADC
+
+  One reading per sample(). The readings go through a
+  first order low-pass (0.3 new, 0.7 old, kept in 1/16
+  LSB so it settles on the reading), which debounces the
+  contacts. The switch turns on once the filtered value
+  rises above onLevel and off once it falls below
+  offLevel; between the two it keeps its state, so noise
+  around one threshold does not make it chatter.
+  sample() returns the change, if any:
+
+      0 -> 1023: on after 5 samples (onLevel 800)
+      1023 -> 0: off after 3 samples (offLevel 400)
+******************************************************/
+class AnalogSwitch
+{
+  public:
+    enum Event {
+      kNone,
+      kOn,
+      kOff,
+    };
+
+    AnalogSwitch(int onLevel, int offLevel)
+    {
+      m_onLevel = (int32_t)onLevel * 16;
+      m_offLevel = (int32_t)offLevel * 16;
+      reset(0);
+    }
+
+    // as if reading had been constant for a long time
+    void reset(int reading)
+    {
+      m_filtered = (int32_t)reading * 16;
+      m_on = m_filtered > m_onLevel;
+    }
+
+    Event sample(int reading)
+    {
+      m_filtered += ((int32_t)reading * 16 - m_filtered) * 3 / 10;
+      if (!m_on && m_filtered > m_onLevel)
+      {
+        m_on = true;
+        return kOn;
+      }
+      if (m_on && m_filtered < m_offLevel)
+      {
+        m_on = false;
+        return kOff;
+      }
+      return kNone;
+    }
+
+    bool on() const { return m_on; }
+    int value() const { return m_filtered / 16; }  // filtered reading
+
+  private:
+    int32_t m_onLevel, m_offLevel;  // 1/16 LSB
+    int32_t m_filtered;             // 1/16 LSB
+    bool m_on;
+};
+#endif
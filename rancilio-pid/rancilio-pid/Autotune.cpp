@@ -0,0 +1,118 @@
+#include "Autotune.h"
+
+#include <Arduino.h>
+#include <math.h>
+
+// maximum spread of the last numCycles periods and amplitudes (relative)
+static const double maxSpread = 0.15;
+// the experiment is aborted if the boiler gets this far above the setpoint
+static const double maxOvershoot = 5;
+
+Autotune::Autotune()
+{
+    m_state = kIdle;
+    m_cycles = 0;
+    m_ku = m_tu = m_amplitude = 0;
+}
+
+void Autotune::start(double setPoint, double outputHigh, double outputLow, double hysteresis,
+                     unsigned long timeoutMs)
+{
+    m_state        = kRunning;
+    m_setPoint     = setPoint;
+    m_outputHigh   = outputHigh;
+    m_outputLow    = outputLow;
+    m_hysteresis   = hysteresis;
+    m_startMs      = millis();
+    m_timeoutMs    = timeoutMs;
+    m_heating      = true;
+    m_cycleStarted = false;
+    m_max          = -1e9;
+    m_min          = 1e9;
+    m_cycles       = 0;
+    m_ku = m_tu = m_amplitude = 0;
+}
+
+void Autotune::stop()
+{
+    if (m_state == kRunning) m_state = kIdle;
+}
+
+double Autotune::update(double input)
+{
+    if (m_state != kRunning) return m_outputLow;
+
+    unsigned long now = millis();
+    if (now - m_startMs > m_timeoutMs || input > m_setPoint + maxOvershoot)
+    {
+        m_state = kFailed;
+        return m_outputLow;
+    }
+
+    if (input > m_max) m_max = input;
+    if (input < m_min) m_min = input;
+
+    if (m_heating && input > m_setPoint + m_hysteresis)
+    {
+        m_heating = false;
+    }
+    else if (!m_heating && input < m_setPoint - m_hysteresis)
+    {
+        // a cycle runs from one switch-on to the next
+        m_heating = true;
+        if (m_cycleStarted) cycleDone(now);
+        m_cycleStarted = true;
+        m_cycleStartMs = now;
+        m_max = m_min = input;
+    }
+
+    return m_heating ? m_outputHigh : m_outputLow;
+}
+
+void Autotune::cycleDone(unsigned long now)
+{
+    // ring of the last numCycles cycles
+    int i = m_cycles % numCycles;
+    m_periods[i] = (now - m_cycleStartMs) / 1000.0;
+    m_amplitudes[i] = (m_max - m_min) / 2;
+    m_cycles++;
+
+    if (m_cycles < numCycles) return;
+
+    double tu = 0, a = 0;
+    double tuMin = 1e9, tuMax = 0, aMin = 1e9, aMax = 0;
+    for (int c = 0; c < numCycles; c++)
+    {
+        tu += m_periods[c] / numCycles;
+        a += m_amplitudes[c] / numCycles;
+        tuMin = fmin(tuMin, m_periods[c]);
+        tuMax = fmax(tuMax, m_periods[c]);
+        aMin = fmin(aMin, m_amplitudes[c]);
+        aMax = fmax(aMax, m_amplitudes[c]);
+    }
+    if (tuMax - tuMin > maxSpread * tu || aMax - aMin > maxSpread * a) return;  // not settled yet
+    if (a <= m_hysteresis) return;
+
+    m_tu = tu;
+    m_amplitude = a;
+    m_ku = 4 * (m_outputHigh - m_outputLow) / 2 / (M_PI * sqrt(a * a - m_hysteresis * m_hysteresis));
+    m_state = kDone;
+}
+
+PidGains Autotune::normalGains() const
+{
+    PidGains g = { m_ku / 2.2, 2.2 * m_tu, m_tu / 6.3 };
+    return g;
+}
+
+PidGains Autotune::coldStartGains() const
+{
+    PidGains g = { 0.45 * m_ku, m_tu / 1.2, 0 };
+    return g;
+}
+
+PidGains Autotune::brewGains() const
+{
+    PidGains g = { 0.8 * m_ku, 0, m_tu / 8 };
+    return g;
+}
@@ -0,0 +1,68 @@
+#ifndef Autotune_h
+#define Autotune_h
+
+/********************************************************
+  Relay feedback autotune (Astroem/Haegglund)
+
+  The heater is switched between outputHigh and outputLow
+  (ms per PID window) with a hysteresis around the setpoint.
+  The boiler settles into a limit cycle whose amplitude a
+  and period Tu give the ultimate gain
+      Ku = 4 d / (pi * sqrt(a^2 - h^2)),  d = (high - low) / 2
+  and the gain sets are derived from Ku and Tu.
+
+  update() is called every loop() pass with the current
+  Input and returns the heater output to apply.
+******************************************************/
+
+struct PidGains
+{
+    double kp;
+    double tn;  // s, 0 = no integral part
+    double tv;  // s
+};
+
+class Autotune
+{
+  public:
+    enum State { kIdle, kRunning, kDone, kFailed };
+
+    static const int numCycles = 4;  // cycles that have to agree before the result is used
+
+    Autotune();
+
+    void start(double setPoint, double outputHigh, double outputLow, double hysteresis,
+               unsigned long timeoutMs);
+    void stop();
+    double update(double input);
+
+    State state() const { return m_state; }
+    int cycles() const { return m_cycles; }
+
+    double ultimateGain() const { return m_ku; }
+    double ultimatePeriod() const { return m_tu; }     // s
+    double amplitude() const { return m_amplitude; }   // C, half peak to peak
+
+    PidGains normalGains() const;     // Tyreus-Luyben PID, little overshoot
+    PidGains coldStartGains() const;  // Ziegler-Nichols PI, used with P on measurement
+    PidGains brewGains() const;       // Ziegler-Nichols PD, fast recovery after a shot
+
+  private:
+    void cycleDone(unsigned long now);
+
+    State m_state;
+    double m_setPoint, m_outputHigh, m_outputLow, m_hysteresis;
+    unsigned long m_startMs, m_timeoutMs;
+
+    bool m_heating;
+    bool m_cycleStarted;
+    unsigned long m_cycleStartMs;
+    double m_max, m_min;
+
+    int m_cycles;
+    double m_periods[numCycles];
+    double m_amplitudes[numCycles];
+
+    double m_ku, m_tu, m_amplitude;
+};
+#endif
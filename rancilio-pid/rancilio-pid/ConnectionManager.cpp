@@ -0,0 +1,146 @@
+#include "ConnectionManager.h"
+
+#include <Arduino.h>
+
+ConnectionManager::ConnectionManager(unsigned long minBackoffMs, unsigned long maxBackoffMs)
+{
+    m_count = 0;
+    m_hold = false;
+    m_minBackoffMs = minBackoffMs;
+    m_maxBackoffMs = maxBackoffMs;
+}
+
+int ConnectionManager::add(const char* name, StartFunction start, ConnectedFunction connected,
+                           unsigned long timeoutMs, int parent)
+{
+    if (m_count >= maxLinks) return -1;
+
+    Link& l     = m_links[m_count];
+    l.name      = name;
+    l.start     = start;
+    l.connected = connected;
+    l.timeoutMs = timeoutMs;
+    l.parent    = parent;
+    l.state     = kLinkDown;
+    l.sinceMs   = millis();
+    l.backoffMs = m_minBackoffMs;
+    l.attempts = l.connects = l.failures = l.failedInRow = l.drops = 0;
+    l.connectingMs = l.callUs = l.maxCallUs = 0;
+    return m_count++;
+}
+
+void ConnectionManager::resetStats()
+{
+    for (int i = 0; i < m_count; i++)
+    {
+        Link& l = m_links[i];
+        l.attempts = l.connects = l.failures = l.drops = 0;
+        l.connectingMs = l.callUs = l.maxCallUs = 0;
+    }
+}
+
+const char* ConnectionManager::stateName(LinkState state)
+{
+    switch (state)
+    {
+        case kLinkDown:       return "down";
+        case kLinkConnecting: return "connecting";
+        case kLinkUp:         return "up";
+        case kLinkBackoff:    return "backoff";
+    }
+    return "?";
+}
+
+void ConnectionManager::enter(Link& l, LinkState state, unsigned long now)
+{
+    if (l.state == kLinkConnecting) l.connectingMs += now - l.sinceMs;
+    l.state = state;
+    l.sinceMs = now;
+}
+
+void ConnectionManager::startAttempt(Link& l, unsigned long now)
+{
+    l.attempts++;
+    enter(l, kLinkConnecting, now);
+
+    unsigned long start = micros();
+    l.start();
+    unsigned long us = micros() - start;
+    l.callUs += us;
+    if (us > l.maxCallUs) l.maxCallUs = us;
+}
+
+bool ConnectionManager::attemptConnected(Link& l)
+{
+    unsigned long start = micros();
+    bool connected = l.connected();
+    unsigned long us = micros() - start;
+    l.callUs += us;
+    if (us > l.maxCallUs) l.maxCallUs = us;
+    return connected;
+}
+
+void ConnectionManager::poll()
+{
+    for (int i = 0; i < m_count; i++)
+    {
+        Link& l = m_links[i];
+        unsigned long now = millis();
+        bool parentUp = l.parent < 0 || up(l.parent);
+
+        switch (l.state)
+        {
+            case kLinkUp:
+                if (!parentUp || !l.connected())
+                {
+                    l.drops++;
+                    enter(l, kLinkDown, now);
+                }
+                break;
+
+            case kLinkDown:
+                if (!parentUp) break;
+                if (l.connected())
+                {
+                    // came up on its own (boot, auto reconnect)
+                    l.connects++;
+                    l.failedInRow = 0;
+                    enter(l, kLinkUp, now);
+                }
+                else if (!m_hold)
+                {
+                    startAttempt(l, now);
+                }
+                break;
+
+            case kLinkConnecting:
+                if (!parentUp)
+                {
+                    enter(l, kLinkDown, now);
+                }
+                else if (attemptConnected(l))
+                {
+                    l.connects++;
+                    l.failedInRow = 0;
+                    enter(l, kLinkUp, now);
+                }
+                else if (now - l.sinceMs >= l.timeoutMs)
+                {
+                    l.failures++;
+                    l.failedInRow++;
+                    if (l.failedInRow == 1)
+                        l.backoffMs = m_minBackoffMs;
+                    else if (2 * l.backoffMs < m_maxBackoffMs)
+                        l.backoffMs = 2 * l.backoffMs;
+                    else
+                        l.backoffMs = m_maxBackoffMs;
+                    enter(l, kLinkBackoff, now);
+                }
+                break;
+
+            case kLinkBackoff:
+                if (now - l.sinceMs >= l.backoffMs) enter(l, kLinkDown, now);
+                break;
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef ConnectionManager_h
+#define ConnectionManager_h
+
+#include <stdint.h>
+
+/********************************************************
+  ConnectionManager: non-blocking reconnects of the links
+
+  Every link (WiFi, Blynk, MQTT) is a small state machine
+  that poll() advances by at most one step per call:
+
+      down -> connecting -> up
+                   |         |
+                   v         v (dropped)
+               backoff --> down
+
+  start() only kicks off an attempt and must return within
+  a few ms, connected() reports the state; while the link
+  is connecting it may take the next step of the attempt,
+  within a few ms as well. An attempt
+  that is not up within the link's timeout fails, the next
+  one follows after a backoff that starts at minBackoffMs
+  and doubles up to maxBackoffMs; a connection resets it.
+  A link whose parent is not up is held down without
+  attempts, as are all links while hold() is set (brew).
+
+  Per link: attempts, connects, failures in total and in a
+  row, drops, the time spent connecting and the time spent
+  inside start() and inside connected() while connecting.
+******************************************************/
+class ConnectionManager
+{
+  public:
+    typedef void (*StartFunction)();
+    typedef bool (*ConnectedFunction)();
+
+    enum LinkState {
+      kLinkDown,
+      kLinkConnecting,
+      kLinkUp,
+      kLinkBackoff,
+    };
+
+    struct Link {
+      const char* name;
+      StartFunction start;
+      ConnectedFunction connected;
+      unsigned long timeoutMs;   // attempt fails if not up after this
+      int parent;                // link that has to be up first, -1 = none
+
+      LinkState state;
+      unsigned long sinceMs;     // entered the current state
+      unsigned long backoffMs;   // next backoff
+      uint32_t attempts;
+      uint32_t connects;
+      uint32_t failures;
+      uint32_t failedInRow;      // failures since the last connect
+      uint32_t drops;
+      unsigned long connectingMs;  // time spent in kLinkConnecting
+      unsigned long callUs;        // time spent inside start() and connected() of attempts
+      unsigned long maxCallUs;
+    };
+
+    static const int maxLinks = 4;
+
+    ConnectionManager(unsigned long minBackoffMs, unsigned long maxBackoffMs);
+
+    // returns the link index or -1 if the table is full
+    int add(const char* name, StartFunction start, ConnectedFunction connected, unsigned long timeoutMs,
+            int parent = -1);
+
+    void poll();
+    void hold(bool on) { m_hold = on; }
+    void setMaxBackoff(unsigned long ms) { m_maxBackoffMs = ms; }
+
+    bool up(int i) const { return i >= 0 && i < m_count && m_links[i].state == kLinkUp; }
+    int links() const { return m_count; }
+    const Link& link(int i) const { return m_links[i]; }
+    static const char* stateName(LinkState state);
+    void resetStats();
+
+  private:
+    void enter(Link& l, LinkState state, unsigned long now);
+    void startAttempt(Link& l, unsigned long now);
+    bool attemptConnected(Link& l);
+
+    Link m_links[maxLinks];
+    int m_count;
+    bool m_hold;
+    unsigned long m_minBackoffMs;
+    unsigned long m_maxBackoffMs;
+};
+#endif
@@ -0,0 +1,60 @@
+#ifndef Deadband_h
+#define Deadband_h
+
+#include <math.h>
+
+/********************************************************
+  Deadband: send a telemetry value only when it changed
+
+  Remembers the value last sent. update() says whether
+  the new one has to go out: the first time, when it
+  moved away from the last sent one by more than
+
+      max(absolute, relative * |last sent|)
+
+  (absolute 0: any change), or when nothing was sent for
+  heartbeatMs, so a dashboard or a retained topic never
+  stays stale for longer than that, even after a lost
+  message. A value that becomes or stops being NaN
+  always goes out.
+******************************************************/
+class Deadband
+{
+  public:
+    Deadband(float absolute, float relative, unsigned long heartbeatMs)
+    {
+      m_absolute = absolute;
+      m_relative = relative;
+      m_heartbeatMs = heartbeatMs;
+      reset();
+    }
+
+    // the next update() sends
+    void reset() { m_sent = false; }
+
+    // true: send value now, it is remembered as sent
+    bool update(float value, unsigned long nowMs)
+    {
+      if (m_sent && nowMs - m_sentMs < m_heartbeatMs && !moved(value)) return false;
+      m_last = value;
+      m_sentMs = nowMs;
+      m_sent = true;
+      return true;
+    }
+
+  private:
+    bool moved(float value) const
+    {
+      if (isnan(value) || isnan(m_last)) return isnan(value) != isnan(m_last);
+      float band = m_relative * fabs(m_last);
+      if (band < m_absolute) band = m_absolute;
+      return fabs(value - m_last) > band;
+    }
+
+    float m_absolute, m_relative;
+    unsigned long m_heartbeatMs;
+    bool m_sent;
+    float m_last;
+    unsigned long m_sentMs;
+};
+#endif
@@ -11,7 +11,7 @@ void DebugStreamManager::setup()
 
     #if(DEBUGMETHOD == 2)
 	setInstance(this);
-	String helpCmd = "loghist - print log history\n";
+	helpCmd = "loghist - print log history\n";
 	// helpCmd.concat("bench2 - Benchmark 2");
 
 	Debug.setHelpProjectsCmds(helpCmd);
@@ -19,6 +19,25 @@ void DebugStreamManager::setup()
     #endif  
 }
 
+void DebugStreamManager::addCommand(const char* name, const char* description, void (*function)())
+{
+    #if(DEBUGMETHOD == 1)
+	if (debugAddFunctionVoid(name, function) >= 0) {
+    	debugSetLastFunctionDescription(description);
+    }
+    #endif
+
+    #if(DEBUGMETHOD == 2)
+	if (commands >= maxCommands) return;
+	commandName[commands] = name;
+	commandFunction[commands] = function;
+	commands++;
+	helpCmd.concat(description);
+	helpCmd.concat("\n");
+	Debug.setHelpProjectsCmds(helpCmd);
+    #endif
+}
+
 
 #if (DEBUGMETHOD == 0)
 void DebugStreamManager::writeE(const char* fmt, ...) {} 
@@ -164,6 +183,10 @@ void DebugStreamManager::processCmdRemoteDebug()
 	{
 		loghist();
 	}
+	for (int i = 0; i < commands; i++)
+	{
+		if (lastCmd == commandName[i]) commandFunction[i]();
+	}
 }
 #endif
 
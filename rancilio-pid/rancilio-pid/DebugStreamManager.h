@@ -16,9 +16,18 @@ class DebugStreamManager : public BaseDebugStreamManager
     void writeD(const char* fmt, ...);
     void writeV(const char* fmt, ...);
 
+    // further console commands of the sketch, call after setup()
+    void addCommand(const char* name, const char* description, void (*function)());
+
   private:
     #if (DEBUGMETHOD == 2)
     void processCmdRemoteDebug();
+
+    static const int maxCommands = 8;
+    const char* commandName[maxCommands];
+    void (*commandFunction[maxCommands])();
+    int commands = 0;
+    String helpCmd;
     #endif
 
     #if (DEBUGMETHOD == 1 || DEBUGMETHOD == 2)
@@ -142,7 +142,7 @@ void printScreen()
           u8g2.drawXBMP(40, 2, 8, 8, antenna_NOK_u8g2);
           u8g2.setCursor(88, 2);
           u8g2.print("RC: ");
-          u8g2.print(wifiReconnects);
+          u8g2.print(connection.link(kLinkWifi).failedInRow);
         }
         if (Blynk.connected()) {
           u8g2.drawXBMP(60, 2, 11, 8, blynk_OK_u8g2);
@@ -111,7 +111,7 @@ void printScreen()
           u8g2.drawXBMP(4, 2, 8, 8, antenna_NOK_u8g2);
           u8g2.setCursor(56, 2);
           u8g2.print("RC: ");
-          u8g2.print(wifiReconnects);
+          u8g2.print(connection.link(kLinkWifi).failedInRow);
         }
         if (Blynk.connected()) {
           u8g2.drawXBMP(24, 2, 11, 8, blynk_OK_u8g2);
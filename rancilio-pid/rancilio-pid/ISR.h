@@ -1,28 +1,90 @@
 /********************************************************
-    Timer 1 - ISR for PID calculation and heat realay output
+    Timer 1 - ISR for heat realay output
+    The PID runs in controlTask() (loop context) and
+    publishes the heater on-time, the ISR only switches
+    the relay.
 ******************************************************/
 
 #include <Arduino.h>
+#include "Snapshot.h"
+
+struct HeaterCommand {
+  unsigned int onTime;  // ms per window the heater is on
+  unsigned int window;  // ms, length of the PWM window
+};
+
+struct IsrTiming {
+  volatile uint32_t calls;
+  volatile uint32_t lastCycles;
+  volatile uint32_t maxCycles;
+};
+
+Snapshot<HeaterCommand> heaterCommand;
+IsrTiming isrTiming = {0, 0, 0};
+
+static inline __attribute__((always_inline)) void isrTimingUpdate(uint32_t startCycles) {
+  uint32_t cycles = ESP.getCycleCount() - startCycles;
+  isrTiming.lastCycles = cycles;
+  if (cycles > isrTiming.maxCycles) {
+    isrTiming.maxCycles = cycles;
+  }
+  isrTiming.calls = isrTiming.calls + 1;
+}
+
+/********************************************************
+    Heater tick and firing pattern (userConfig.h)
+    HEATERPWMMODE 0: one on block at the start of the window
+    HEATERPWMMODE 1: sigma-delta, the on-time is spread over
+                     the window in single ticks, the rest
+                     is carried to the next window
+******************************************************/
+#ifndef HEATERPWMMODE
+  #define HEATERPWMMODE 0
+#endif
+#ifndef HEATERTICK
+  #if defined(ESP32)
+    #define HEATERTICK 10
+  #else
+    #define HEATERTICK 20
+  #endif
+#endif
+#if (HEATERTICK < 10 || 1000 % HEATERTICK != 0)
+  #error("HEATERTICK must be >= 10 ms and divide the 1000 ms PID window");
+#endif
+
+unsigned int heaterAccumulator = 0;  // sigma-delta state, ISR only
+
+static inline __attribute__((always_inline)) int heaterLevel(const HeaterCommand& command) {
+  #if (HEATERPWMMODE == 1)
+  if (command.onTime == 0) {
+    return LOW;
+  }
+  heaterAccumulator += command.onTime;
+  if (heaterAccumulator >= command.window) {
+    heaterAccumulator -= command.window;
+    return HIGH;
+  }
+  return LOW;
+  #else
+  return command.onTime <= isrCounter ? LOW : HIGH;
+  #endif
+}
 
 #if defined(ESP8266) // ESP8266
     
     void ICACHE_RAM_ATTR onTimer1ISR() {
-    timer1_write(6250); // set interrupt time to 20ms
+    uint32_t startCycles = ESP.getCycleCount();
+    timer1_write(HEATERTICK * 3125UL / 10); // set interrupt time to HEATERTICK ms, 1 tick = 3.2us
 
-    if (Output <= isrCounter) {
-        digitalWrite(pinRelayHeater, LOW);
-    } else {
-        digitalWrite(pinRelayHeater, HIGH);
-    }
+    HeaterCommand command = heaterCommand.read();
+    digitalWrite(pinRelayHeater, heaterLevel(command));
 
-    isrCounter += 20; // += 20 because one tick = 20ms
+    isrCounter += HEATERTICK;
     //set PID output as relais commands
-    if (isrCounter >= windowSize) {
+    if (isrCounter >= command.window) {
         isrCounter = 0;
     }
-
-    //run PID calculation
-    bPID.Compute();
+    isrTimingUpdate(startCycles);
     }
 #endif
 
@@ -32,28 +94,45 @@ int T1C;
 int TCTE;
 
   void IRAM_ATTR onTimer(){
+    uint32_t startCycles = ESP.getCycleCount();
     
-    //timer1_write(50000); // set interrupt time to 10ms
-      timerAlarmWrite(timer, 10000, true);
-    if (Output <= isrCounter) {
-      digitalWrite(pinRelayHeater, LOW);
-    } else {
-      digitalWrite(pinRelayHeater, HIGH);
-    }
+    timerAlarmWrite(timer, HEATERTICK * 1000UL, true); // set interrupt time to HEATERTICK ms
+    HeaterCommand command = heaterCommand.read();
+    digitalWrite(pinRelayHeater, heaterLevel(command));
   
-    isrCounter += 10; // += 10 because one tick = 10ms
+    isrCounter += HEATERTICK;
     //set PID output as relais commands
-    if (isrCounter >= windowSize) {
+    if (isrCounter >= command.window) {
       isrCounter = 0;
     }
-  
-    //run PID calculation
-    bPID.Compute();
+    isrTimingUpdate(startCycles);
   }
 
  #endif   
 
 
+/********************************************************
+    Control task, called from loop(): runs the PID and
+    hands the heater on-time to the ISR. Output is written
+    here only, so loop() never sees a half written value.
+******************************************************/
+void controlTask(void)
+{
+  PROFILE_SCOPE(profileControl);
+  bPID.Compute();
+
+  HeaterCommand command;
+  command.window = windowSize;
+  double heaterOutput = Output + feedForward;
+  if (heaterOutput > windowSize) {
+    heaterOutput = windowSize;
+  }
+  // ceil keeps the relay pattern of comparing Output against isrCounter
+  command.onTime = heaterOutput > 0 ? (unsigned int)ceil(heaterOutput) : 0;
+  heaterCommand.write(command);
+}
+
+
 void initTimer1(void)
 {
   #if defined(ESP8266)
@@ -66,7 +145,7 @@ void initTimer1(void)
   timer1_isr_init();
   timer1_attachInterrupt(onTimer1ISR);
   //timer1_write(50000); // DIV16: set interrupt time to 10ms
-  timer1_write(6250); // DIV256: set interrupt time to 20ms
+  timer1_write(HEATERTICK * 3125UL / 10); // DIV256: set interrupt time to HEATERTICK ms
   #elif defined(ESP32) // ESP32
   /********************************************************
     Timer1 ISR - Initialisierung
@@ -76,7 +155,7 @@ void initTimer1(void)
   ******************************************************/
   timer = timerBegin(0, 80, true); //m
   timerAttachInterrupt(timer, &onTimer, true);//m
-  timerAlarmWrite(timer, 10000, true);//m
+  timerAlarmWrite(timer, HEATERTICK * 1000UL, true);//m
   #else
   #error("not supported MCU");
   #endif
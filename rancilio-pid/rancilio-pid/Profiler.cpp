@@ -0,0 +1,62 @@
+#include "Profiler.h"
+
+#if (PROFILER == 1)
+
+ProfileStage* ProfileStage::s_first = NULL;
+ProfileStage* ProfileStage::s_last  = NULL;
+
+ProfileStage::ProfileStage(const char* name)
+{
+    m_name = name;
+    m_next = NULL;
+    reset();
+
+    if (s_last)
+        s_last->m_next = this;
+    else
+        s_first = this;
+    s_last = this;
+}
+
+void ProfileStage::reset()
+{
+    m_count     = 0;
+    m_minCycles = 0xFFFFFFFF;
+    m_maxCycles = 0;
+    m_sumCycles = 0;
+    for (int i = 0; i < buckets; i++) m_buckets[i] = 0;
+}
+
+void ProfileStage::add(uint32_t cycles)
+{
+    m_count++;
+    m_sumCycles += cycles;
+    if (cycles < m_minCycles) m_minCycles = cycles;
+    if (cycles > m_maxCycles) m_maxCycles = cycles;
+
+    uint32_t us = cycles / ESP.getCpuFreqMHz();
+    int i = 0;
+    while (us >= 2 && i < buckets - 1)
+    {
+        us >>= 1;
+        i++;
+    }
+    m_buckets[i]++;
+}
+
+uint32_t ProfileStage::minUs() const
+{
+    return m_count ? m_minCycles / ESP.getCpuFreqMHz() : 0;
+}
+
+uint32_t ProfileStage::avgUs() const
+{
+    return m_count ? (uint32_t)(m_sumCycles / m_count / ESP.getCpuFreqMHz()) : 0;
+}
+
+uint32_t ProfileStage::maxUs() const
+{
+    return m_maxCycles / ESP.getCpuFreqMHz();
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef Profiler_h
+#define Profiler_h
+
+#include <Arduino.h>
+#include "userConfig.h"
+
+/********************************************************
+  Profiler: run time of loop stages
+
+  PROFILE_STAGE(var, "name") defines a stage at file
+  scope, PROFILE_SCOPE(var) times the rest of the enclosing
+  block. Durations are CPU cycles (ESP.getCycleCount()),
+  collected per stage as count, min, avg and max and in a
+  histogram of power of two buckets in us:
+      bucket 0: < 2 us, bucket i: 2^i ... 2^(i+1) us,
+      the last bucket holds everything longer.
+  The console command "profile" prints and clears them.
+
+  With PROFILER 0 both macros are empty and nothing of
+  the profiler is compiled.
+******************************************************/
+#ifndef PROFILER
+  #define PROFILER 0
+#endif
+
+#if (PROFILER == 1)
+
+class ProfileStage
+{
+  public:
+    static const int buckets = 16;
+
+    ProfileStage(const char* name);
+
+    void add(uint32_t cycles);
+    void reset();
+
+    const char* name() const { return m_name; }
+    uint32_t count() const { return m_count; }
+    uint32_t minUs() const;
+    uint32_t avgUs() const;
+    uint32_t maxUs() const;
+    uint32_t bucket(int i) const { return m_buckets[i]; }
+
+    // all stages, in order of definition
+    static ProfileStage* first() { return s_first; }
+    ProfileStage* next() const { return m_next; }
+
+  private:
+    const char* m_name;
+    uint32_t m_count;
+    uint32_t m_minCycles, m_maxCycles;
+    uint64_t m_sumCycles;
+    uint32_t m_buckets[buckets];
+
+    ProfileStage* m_next;
+    static ProfileStage* s_first;
+    static ProfileStage* s_last;
+};
+
+class ProfileScope
+{
+  public:
+    ProfileScope(ProfileStage& stage) : m_stage(stage), m_start(ESP.getCycleCount()) {}
+    ~ProfileScope() { m_stage.add(ESP.getCycleCount() - m_start); }
+
+  private:
+    ProfileStage& m_stage;
+    uint32_t m_start;
+};
+
+#define PROFILE_STAGE(var, name) ProfileStage var(name)
+#define PROFILE_SCOPE(var) ProfileScope var##Scope(var)
+
+#else
+
+#define PROFILE_STAGE(var, name)
+#define PROFILE_SCOPE(var)
+
+#endif
+#endif
@@ -0,0 +1,97 @@
+#include "PulseTrain.h"
+
+#include <Arduino.h>
+
+PulseTrain::PulseTrain(unsigned long mergeMs, unsigned long continuousMs, unsigned long gapMs)
+{
+    m_mergeUs = mergeMs * 1000;
+    m_continuousUs = continuousMs * 1000;
+    m_gapUs = gapMs * 1000;
+    m_head = m_tail = 0;
+    m_lost = 0;
+    m_edges = 0;
+    begin(false, 0);
+}
+
+void PulseTrain::begin(bool active, uint32_t nowUs)
+{
+    m_level = m_on = m_pulsed = false;
+    m_lastOffUs = m_burstStartUs = m_burstEndUs = nowUs;
+    m_burstStartMs = 0;
+    m_periodUs = m_lastBurstUs = 0;
+    m_nowUs = nowUs;
+    m_kind = kIdle;
+    if (active) edge(true, nowUs);
+}
+
+void PulseTrain::update(uint32_t nowUs)
+{
+    while (m_tail != m_head)
+    {
+        Edge e = m_ring[m_tail & (ringSize - 1)];
+        m_tail = m_tail + 1;
+        m_edges++;
+        m_level = e.active;
+        if (!e.active)
+        {
+            m_lastOffUs = e.us;
+            continue;
+        }
+        if (!m_on)
+        {
+            if (m_lastBurstUs) m_periodUs = e.us - m_burstStartUs;  // there was a burst before
+            m_on = true;
+            m_burstStartUs = e.us;
+            m_burstStartMs = millis() - (nowUs - e.us) / 1000;
+        }
+    }
+
+    if (m_on && !m_level && nowUs - m_lastOffUs >= m_mergeUs)
+    {
+        m_on = false;
+        m_burstEndUs = m_lastOffUs;
+        m_lastBurstUs = m_burstEndUs - m_burstStartUs;
+        m_pulsed = m_lastBurstUs < m_continuousUs;
+    }
+    m_nowUs = nowUs;
+    classify(nowUs);
+}
+
+void PulseTrain::classify(uint32_t nowUs)
+{
+    if (m_on)
+    {
+        if (nowUs - m_burstStartUs >= m_continuousUs) m_kind = kContinuous;
+        else m_kind = m_pulsed ? kPulsed : kStarting;
+        return;
+    }
+    if (m_pulsed && nowUs - m_burstEndUs >= m_gapUs) m_pulsed = false;
+    m_kind = m_pulsed ? kPulsed : kIdle;
+}
+
+unsigned long PulseTrain::burstMs() const
+{
+    return (m_on ? m_nowUs - m_burstStartUs : m_lastBurstUs) / 1000;
+}
+
+float PulseTrain::pulseHz() const
+{
+    return m_periodUs ? 1e6f / m_periodUs : 0;
+}
+
+float PulseTrain::duty() const
+{
+    return m_periodUs ? (float)m_lastBurstUs / m_periodUs : 0;
+}
+
+const char* PulseTrain::kindName(Kind kind)
+{
+    switch (kind)
+    {
+        case kIdle:       return "idle";
+        case kStarting:   return "starting";
+        case kContinuous: return "continuous";
+        case kPulsed:     return "pulsed";
+    }
+    return "?";
+}
@@ -0,0 +1,102 @@
+#ifndef PulseTrain_h
+#define PulseTrain_h
+
+#include <stdint.h>
+
+/********************************************************
+  PulseTrain: pump voltage sensor edges to pump bursts
+
+  The pin interrupt hands every edge with its micros()
+  to edge(), which only stores it in a ring. update()
+  takes them in loop context. A burst starts at the first
+  active edge and ends once the input has been inactive
+  for mergeMs, so a sensor that passes the half waves of
+  the AC pump voltage (50 Hz: 10 ms on, 10 ms off) gives
+  one burst per pump run, like a smoothed one.
+
+      kIdle        pump off
+      kStarting    pump on for less than continuousMs
+      kContinuous  pump on for continuousMs or longer:
+                   brew or cooling flush
+      kPulsed      bursts shorter than continuousMs that
+                   follow each other within gapMs: the
+                   steam pump of a thermoblock (pulse rate
+                   above 1 / gapMs, on time below
+                   continuousMs)
+
+  Times of the current burst, the last pulse period and
+  its duty are kept for the log.
+******************************************************/
+class PulseTrain
+{
+  public:
+    enum Kind {
+      kIdle,
+      kStarting,
+      kContinuous,
+      kPulsed,
+    };
+
+    static const uint8_t ringSize = 32;  // edges between two update(), power of 2
+
+    PulseTrain(unsigned long mergeMs, unsigned long continuousMs, unsigned long gapMs);
+
+    // the input level at start, before the interrupt is attached
+    void begin(bool active, uint32_t nowUs);
+
+    // interrupt context: the input changed to active or inactive
+    inline __attribute__((always_inline)) void edge(bool active, uint32_t us)
+    {
+      uint8_t head = m_head;
+      if ((uint8_t)(head - m_tail) >= ringSize)
+      {
+        m_lost = m_lost + 1;
+        return;
+      }
+      m_ring[head & (ringSize - 1)].us = us;
+      m_ring[head & (ringSize - 1)].active = active;
+      m_head = head + 1;
+    }
+
+    // loop context: takes the stored edges, ends a burst after mergeMs
+    void update(uint32_t nowUs);
+
+    Kind kind() const { return m_kind; }
+    bool active() const { return m_on; }                 // pump running
+    unsigned long burstStartMs() const { return m_burstStartMs; }  // millis() the current or last burst started
+    unsigned long burstMs() const;                       // length of the current or last burst
+    float pulseHz() const;                               // start to start of the last two bursts, 0 = none
+    float duty() const;                                  // on share of that period
+
+    uint32_t edges() const { return m_edges; }
+    uint32_t lost() const { return m_lost; }             // ring was full
+    static const char* kindName(Kind kind);
+
+  private:
+    struct Edge {
+      uint32_t us;
+      bool active;
+    };
+
+    void classify(uint32_t nowUs);
+
+    uint32_t m_mergeUs, m_continuousUs, m_gapUs;
+
+    Edge m_ring[ringSize];
+    volatile uint8_t m_head;     // written by edge()
+    volatile uint8_t m_tail;     // written by update()
+    volatile uint32_t m_lost;
+
+    bool m_level;                // input level after the last edge
+    bool m_on;                   // in a burst
+    bool m_pulsed;               // the last burst was short and the gap is not over
+    uint32_t m_lastOffUs;        // last inactive edge
+    uint32_t m_burstStartUs, m_burstEndUs;
+    unsigned long m_burstStartMs;
+    uint32_t m_periodUs;         // start to start of the last two bursts
+    uint32_t m_lastBurstUs;      // length of the last finished burst
+    uint32_t m_edges;
+    uint32_t m_nowUs;
+    Kind m_kind;
+};
+#endif
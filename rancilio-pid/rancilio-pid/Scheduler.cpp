@@ -0,0 +1,121 @@
+#include "Scheduler.h"
+
+#include <Arduino.h>
+
+Scheduler::Scheduler()
+{
+    m_count = 0;
+    m_controlPriority = 0;
+}
+
+int Scheduler::add(const char* name, TaskFunction function, unsigned long intervalMs, uint8_t priority,
+                   bool deferrable)
+{
+    if (m_count >= maxTasks) return -1;
+
+    Task& t      = m_tasks[m_count];
+    t.name       = name;
+    t.function   = function;
+    t.intervalMs = intervalMs;
+    t.priority   = priority;
+    t.deferrable = deferrable;
+    t.nextMs     = millis() + intervalMs;
+    t.deferredMs = 0;
+    t.runs = t.overruns = t.deferrals = 0;
+    t.maxJitterMs = t.avgRunUs = t.maxRunUs = 0;
+    return m_count++;
+}
+
+void Scheduler::start()
+{
+    unsigned long now = millis();
+    for (int i = 0; i < m_count; i++) m_tasks[i].nextMs = now + m_tasks[i].intervalMs;
+}
+
+void Scheduler::resetStats()
+{
+    for (int i = 0; i < m_count; i++)
+    {
+        Task& t = m_tasks[i];
+        t.runs = t.overruns = t.deferrals = 0;
+        t.maxJitterMs = t.maxRunUs = 0;
+    }
+}
+
+bool Scheduler::controlDueWithin(unsigned long now, unsigned long us) const
+{
+    long withinMs = (us + 999) / 1000;
+    for (int i = 0; i < m_count; i++)
+    {
+        const Task& t = m_tasks[i];
+        if (t.deferrable || t.intervalMs == 0 || t.priority < m_controlPriority) continue;
+        if ((long)(t.nextMs - now) <= withinMs) return true;
+    }
+    return false;
+}
+
+void Scheduler::run()
+{
+    uint32_t considered = 0;  // bit per task, each task runs at most once per pass
+    unsigned long now = millis();
+
+    for (;;)
+    {
+        // most urgent due task: priority, then lateness
+        int best = -1;
+        long bestLate = 0;
+        for (int i = 0; i < m_count; i++)
+        {
+            if (considered & (1UL << i)) continue;
+            long late = (long)(now - m_tasks[i].nextMs);
+            if (late < 0) continue;
+            if (best < 0 || m_tasks[i].priority > m_tasks[best].priority ||
+                (m_tasks[i].priority == m_tasks[best].priority && late > bestLate))
+            {
+                best = i;
+                bestLate = late;
+            }
+        }
+        if (best < 0) return;
+        considered |= 1UL << best;
+
+        Task& t = m_tasks[best];
+        if (t.deferrable && controlDueWithin(now, t.avgRunUs))
+        {
+            if (t.deferredMs == 0) t.deferredMs = now | 1;
+            if (now - t.deferredMs < maxDeferMs)
+            {
+                t.deferrals++;
+                continue;
+            }
+        }
+        t.deferredMs = 0;
+
+        unsigned long start = micros();
+        t.function();
+        unsigned long runUs = micros() - start;
+
+        t.runs++;
+        t.avgRunUs = t.avgRunUs - t.avgRunUs / 8 + runUs / 8;
+        if (runUs > t.maxRunUs) t.maxRunUs = runUs;
+
+        if (t.intervalMs == 0)
+        {
+            t.nextMs = now;
+        }
+        else
+        {
+            if ((unsigned long)bestLate > t.maxJitterMs) t.maxJitterMs = bestLate;
+            if ((unsigned long)bestLate >= t.intervalMs)
+            {
+                t.overruns++;
+                t.nextMs = now + t.intervalMs;
+            }
+            else
+            {
+                t.nextMs += t.intervalMs;
+            }
+        }
+        now = millis();
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef Scheduler_h
+#define Scheduler_h
+
+#include <stdint.h>
+
+/********************************************************
+  Scheduler: cooperative periodic tasks for loop()
+
+  run() starts every due task once, the highest priority
+  first and among equal priorities the one that is most
+  late. A task is due interval ms after its last due time,
+  so it keeps its phase. A task that starts a whole
+  interval late or more has overrun: the missed periods
+  are dropped and it is due again one interval after the
+  start. Interval 0 runs the task on every pass.
+
+  Deferrable tasks (network) are held back while a
+  control task is due within their average run time, for
+  at most maxDeferMs. Control tasks are the periodic ones
+  (interval > 0) of controlPriority or higher; a poll task
+  is always due and would hold them back on every pass.
+
+  Per task: runs, worst start jitter (ms after the due
+  time), overruns, deferrals and run time.
+******************************************************/
+class Scheduler
+{
+  public:
+    typedef void (*TaskFunction)();
+
+    struct Task {
+      const char* name;
+      TaskFunction function;
+      unsigned long intervalMs;
+      uint8_t priority;          // higher runs first
+      bool deferrable;
+
+      unsigned long nextMs;      // due time
+      unsigned long deferredMs;  // first deferral of the pending run, 0 = not deferred
+      uint32_t runs;
+      uint32_t overruns;
+      uint32_t deferrals;
+      unsigned long maxJitterMs;
+      unsigned long avgRunUs;    // exponential average, 1/8 per run
+      unsigned long maxRunUs;
+    };
+
+    static const int maxTasks = 16;
+    static const unsigned long maxDeferMs = 200;
+
+    Scheduler();
+
+    // returns the task index or -1 if the table is full
+    int add(const char* name, TaskFunction function, unsigned long intervalMs, uint8_t priority,
+            bool deferrable = false);
+
+    // every task is due one interval from now
+    void start();
+    void setControlPriority(uint8_t priority) { m_controlPriority = priority; }
+    void run();
+
+    int tasks() const { return m_count; }
+    const Task& task(int i) const { return m_tasks[i]; }
+    void resetStats();
+
+  private:
+    bool controlDueWithin(unsigned long now, unsigned long us) const;
+
+    Task m_tasks[maxTasks];
+    int m_count;
+    uint8_t m_controlPriority;
+};
+#endif
@@ -0,0 +1,155 @@
+#ifndef SensorFilter_h
+#define SensorFilter_h
+
+#include <math.h>
+
+/********************************************************
+  SensorFilter: Hampel filter for temperature readings
+
+  Keeps the last N readings in range (spikes included),
+  in arrival order and sorted. A reading is checked
+  against the window before it is added:
+    out of range  outside minC..maxC (fault codes like
+                  -127 of the DS18B20), not added
+    spike         further than limit * scale from the
+                  median, scale = 1.4826 * MAD, at least
+                  minScale (quantised sensors have MAD 0)
+    stuck         the same value stuckReadings times in a
+                  row while driven (0 = off): the caller
+                  says whether the value has to move, e.g.
+                  the heater runs hard. A good sensor at a
+                  steady temperature repeats its value for
+                  as long as it likes.
+  A real step is a spike until it is the median of the
+  window, after (N + 1) / 2 readings; a ramp widens the
+  MAD and passes. Median and MAD take O(N) per reading:
+  one shift to insert into the sorted window and a walk
+  outwards from the median for the MAD.
+******************************************************/
+template <int N>
+class SensorFilter
+{
+  public:
+    enum Verdict {
+      kValid,
+      kOutOfRange,
+      kSpike,
+      kStuck,
+    };
+
+    SensorFilter(float minC, float maxC, float limit, float minScale, unsigned int stuckReadings)
+    {
+      m_minC = minC;
+      m_maxC = maxC;
+      m_limit = limit;
+      m_minScale = minScale;
+      m_stuckReadings = stuckReadings;
+      reset();
+    }
+
+    void reset()
+    {
+      m_count = 0;
+      m_next = 0;
+      m_last = 0;
+      m_run = 0;
+      m_drivenRun = 0;
+      m_maxRun = 0;
+    }
+
+    Verdict check(float value, bool driven = true)
+    {
+      if (!(value >= m_minC && value <= m_maxC)) return kOutOfRange;
+
+      bool same = m_count > 0 && value == m_last;
+      m_run = same ? m_run + 1 : 1;
+      m_drivenRun = same && driven ? m_drivenRun + 1 : (driven ? 1 : 0);
+      m_last = value;
+      if (m_run > m_maxRun) m_maxRun = m_run;
+
+      Verdict verdict = kValid;
+      if (m_count >= 3 && fabs(value - median()) > m_limit * scale()) verdict = kSpike;
+      add(value);
+      if (verdict == kValid && m_stuckReadings > 0 && m_drivenRun >= m_stuckReadings) verdict = kStuck;
+      return verdict;
+    }
+
+    // lower median of the window
+    float median() const { return m_count ? m_sorted[(m_count - 1) / 2] : 0; }
+
+    // 1.4826 * MAD, the standard deviation for normal noise, at least minScale
+    float scale() const
+    {
+      float s = 1.4826f * mad();
+      return s > m_minScale ? s : m_minScale;
+    }
+
+    unsigned int run() const { return m_run; }        // same value in a row
+    unsigned int drivenRun() const { return m_drivenRun; }  // of those, in a row while driven
+    unsigned int maxRun() const { return m_maxRun; }
+    void resetMaxRun() { m_maxRun = m_run; }
+
+    static const char* verdictName(Verdict verdict)
+    {
+      switch (verdict)
+      {
+        case kValid:      return "valid";
+        case kOutOfRange: return "out of range";
+        case kSpike:      return "spike";
+        case kStuck:      return "stuck";
+      }
+      return "?";
+    }
+
+  private:
+    void add(float value)
+    {
+      int i;
+      if (m_count == N)
+      {
+        // drop the oldest from the sorted window
+        float oldest = m_ring[m_next];
+        for (i = 0; m_sorted[i] != oldest; i++) {}
+        for (; i < m_count - 1; i++) m_sorted[i] = m_sorted[i + 1];
+        m_count--;
+      }
+      for (i = m_count; i > 0 && m_sorted[i - 1] > value; i--) m_sorted[i] = m_sorted[i - 1];
+      m_sorted[i] = value;
+      m_count++;
+      m_ring[m_next] = value;
+      m_next = m_next + 1 < N ? m_next + 1 : 0;
+    }
+
+    // median of |x - median|: the deviations grow outwards from the median
+    // on both sides of the sorted window, merge them up to the middle one
+    float mad() const
+    {
+      int mid = (m_count - 1) / 2;
+      float med = m_sorted[mid];
+      int lo = mid - 1, hi = mid + 1;
+      float d = 0;
+      for (int k = 1; k <= mid; k++)
+      {
+        float dl = lo >= 0 ? med - m_sorted[lo] : INFINITY;
+        float dh = hi < m_count ? m_sorted[hi] - med : INFINITY;
+        if (dl <= dh) { d = dl; lo--; }
+        else { d = dh; hi++; }
+      }
+      return d;
+    }
+
+    float m_minC, m_maxC;
+    float m_limit;
+    float m_minScale;
+    unsigned int m_stuckReadings;
+
+    float m_ring[N];         // arrival order, m_next is the oldest once full
+    float m_sorted[N];
+    int m_count;
+    int m_next;
+    float m_last;
+    unsigned int m_run;
+    unsigned int m_drivenRun;  // of m_run, readings while driven
+    unsigned int m_maxRun;
+};
+#endif
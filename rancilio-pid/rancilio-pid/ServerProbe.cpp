@@ -0,0 +1,190 @@
+#include "ServerProbe.h"
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+  #include <WiFi.h>
+#else
+  #include <lwip/dns.h>
+  #include <lwip/tcp.h>
+#endif
+
+ServerProbe::ServerProbe(unsigned long timeoutMs)
+{
+    m_host = "";
+    m_port = 0;
+    m_timeoutMs = timeoutMs;
+    m_startMs = 0;
+    m_state = kIdle;
+    m_address = 0;
+#if defined(ESP32)
+    m_running = false;
+    m_id = 0;
+#else
+    m_pcb = NULL;
+    m_resolving = false;
+#endif
+}
+
+ServerProbe::State ServerProbe::poll()
+{
+    if (m_state == kProbing && millis() - m_startMs >= m_timeoutMs)
+    {
+        abort();
+        m_state = kUnreachable;
+    }
+    return m_state;
+}
+
+void ServerProbe::done()
+{
+    abort();
+    m_state = kIdle;
+}
+
+#if defined(ESP32)
+
+static portMUX_TYPE probeMux = portMUX_INITIALIZER_UNLOCKED;
+
+struct ServerProbeStack
+{
+    static void task(void* arg)
+    {
+        ServerProbe* p = (ServerProbe*)arg;
+        uint32_t id = p->m_id;
+
+        IPAddress ip;
+        bool ok = WiFi.hostByName(p->m_host, ip) == 1;
+        if (ok)
+        {
+            WiFiClient client;
+            ok = client.connect(ip, p->m_port, p->m_timeoutMs) == 1;
+            client.stop();
+        }
+
+        portENTER_CRITICAL(&probeMux);
+        if (id == p->m_id && p->m_state == ServerProbe::kProbing)
+        {
+            p->m_address = (uint32_t)ip;
+            p->m_state = ok ? ServerProbe::kReachable : ServerProbe::kUnreachable;
+        }
+        p->m_running = false;
+        portEXIT_CRITICAL(&probeMux);
+        vTaskDelete(NULL);
+    }
+};
+
+void ServerProbe::start(const char* host, uint16_t port)
+{
+    done();
+    m_host = host;
+    m_port = port;
+    m_startMs = millis();
+    if (m_running)
+    {
+        // the task of the last probe has not given up yet, this attempt fails
+        m_state = kUnreachable;
+        return;
+    }
+    m_state = kProbing;
+    m_running = true;
+    if (xTaskCreate(ServerProbeStack::task, "probe", 4096, this, 1, NULL) != pdPASS)
+    {
+        m_running = false;
+        m_state = kUnreachable;
+    }
+}
+
+void ServerProbe::abort()
+{
+    portENTER_CRITICAL(&probeMux);
+    m_id++;
+    portEXIT_CRITICAL(&probeMux);
+}
+
+#else
+
+struct ServerProbeStack
+{
+    static void connect(ServerProbe* p, const ip_addr_t* address)
+    {
+        p->m_address = ip_2_ip4(address)->addr;
+        p->m_pcb = tcp_new();
+        if (p->m_pcb == NULL)
+        {
+            p->m_state = ServerProbe::kUnreachable;
+            return;
+        }
+        tcp_arg(p->m_pcb, p);
+        tcp_err(p->m_pcb, error);
+        if (tcp_connect(p->m_pcb, address, p->m_port, connected) != ERR_OK)
+        {
+            p->abort();
+            p->m_state = ServerProbe::kUnreachable;
+        }
+    }
+
+    static void found(const char* name, const ip_addr_t* address, void* arg)
+    {
+        ServerProbe* p = (ServerProbe*)arg;
+        if (!p->m_resolving) return;   // done() or timed out meanwhile
+        p->m_resolving = false;
+        if (address != NULL)
+            connect(p, address);
+        else
+            p->m_state = ServerProbe::kUnreachable;
+    }
+
+    static err_t connected(void* arg, struct tcp_pcb* pcb, err_t err)
+    {
+        ServerProbe* p = (ServerProbe*)arg;
+        p->abort();
+        p->m_state = ServerProbe::kReachable;
+        return ERR_ABRT;
+    }
+
+    // refused or given up, lwIP has freed the pcb
+    static void error(void* arg, err_t err)
+    {
+        ServerProbe* p = (ServerProbe*)arg;
+        if (p == NULL) return;
+        p->m_pcb = NULL;
+        p->m_state = ServerProbe::kUnreachable;
+    }
+};
+
+void ServerProbe::start(const char* host, uint16_t port)
+{
+    done();
+    m_host = host;
+    m_port = port;
+    m_startMs = millis();
+    m_state = kProbing;
+
+    ip_addr_t address;
+    m_resolving = true;
+    err_t err = dns_gethostbyname(host, &address, ServerProbeStack::found, this);
+    if (err == ERR_OK)
+    {
+        // dotted address or cached name
+        m_resolving = false;
+        ServerProbeStack::connect(this, &address);
+    }
+    else if (err != ERR_INPROGRESS)
+    {
+        m_resolving = false;
+        m_state = kUnreachable;
+    }
+}
+
+void ServerProbe::abort()
+{
+    m_resolving = false;
+    if (m_pcb == NULL) return;
+    struct tcp_pcb* pcb = m_pcb;
+    m_pcb = NULL;
+    tcp_arg(pcb, NULL);   // no error callback for our own abort
+    tcp_abort(pcb);
+}
+
+#endif
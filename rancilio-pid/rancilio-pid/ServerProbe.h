@@ -0,0 +1,70 @@
+#ifndef ServerProbe_h
+#define ServerProbe_h
+
+#include <stdint.h>
+
+/********************************************************
+  ServerProbe: DNS lookup and TCP handshake without
+  blocking the loop
+
+  Blynk.connect() and mqtt.connect() look the host name
+  up and wait for the TCP handshake. With the server gone
+  that blocks for the client's connect timeout (ESP8266:
+  5 s). start() only hands both to the network stack,
+  poll() reports the result:
+
+      kIdle         not started, or done()
+      kProbing      lookup or handshake running
+      kReachable    the server accepted the connection,
+                    address() is its IPv4 address
+      kUnreachable  lookup failed, connection refused or
+                    no answer within timeoutMs
+
+  The probe connection is aborted as soon as it is up.
+  The library then connects to address(): no lookup, and
+  the handshake with a server that just answered takes
+  one round trip.
+
+  ESP8266: lwIP raw API, its callbacks run between loop
+  passes. ESP32: lwIP runs in its own task, the probe
+  runs the blocking calls in a short-lived task of its
+  own and hands the result over under a spinlock.
+******************************************************/
+class ServerProbe
+{
+  public:
+    enum State {
+      kIdle,
+      kProbing,
+      kReachable,
+      kUnreachable,
+    };
+
+    explicit ServerProbe(unsigned long timeoutMs);
+
+    // host: name or dotted address, has to stay valid
+    void start(const char* host, uint16_t port);
+    State poll();
+    void done();   // aborts a running probe
+    uint32_t address() const { return m_address; }   // network order, as IPAddress(uint32_t)
+
+  private:
+    friend struct ServerProbeStack;
+
+    void abort();
+
+    const char* m_host;
+    uint16_t m_port;
+    unsigned long m_timeoutMs;
+    unsigned long m_startMs;
+    volatile State m_state;
+    volatile uint32_t m_address;
+#if defined(ESP32)
+    volatile bool m_running;    // the probe task has not returned yet
+    volatile uint32_t m_id;     // results of an older probe are dropped
+#else
+    struct tcp_pcb* m_pcb;
+    bool m_resolving;           // a lookup of this probe is pending
+#endif
+};
+#endif
@@ -0,0 +1,87 @@
+#ifndef SlopeEstimator_h
+#define SlopeEstimator_h
+
+/********************************************************
+  SlopeEstimator: least squares slope over the last N
+  equally spaced samples, updated in constant time.
+
+  Samples are kept as float in a ring, only the running
+  sums Sum(y) and Sum(x*y) (x = 0 oldest ... N-1 newest)
+  are double. Sliding the window by one sample:
+      Sxy' = Sxy - (Sy - y_oldest) + (N-1) * y_new
+      Sy'  = Sy - y_oldest + y_new
+  slope = (12 Sxy - 6 (N-1) Sy) / (N (N^2 - 1)) per sample
+  The sums of float samples are exact in double, so they
+  do not drift however long the window runs.
+
+  add(value, ms) takes the time of the sample: slots of
+  readings that were skipped since the last one are
+  filled in on the line between the two, so the spacing
+  stays the one the slope assumes; a gap of a whole
+  window starts it over.
+******************************************************/
+template <int N>
+class SlopeEstimator
+{
+  public:
+    SlopeEstimator(unsigned long sampleIntervalMs)
+    {
+      m_sampleIntervalMs = sampleIntervalMs;
+      m_sampleIntervalS = sampleIntervalMs / 1000.0;
+      reset(0);
+    }
+
+    // fill the whole window with value, slope 0
+    void reset(float value)
+    {
+      for (int i = 0; i < N; i++) m_samples[i] = value;
+      m_next = 0;
+      m_sumY = (double)N * value;
+      m_sumXY = (double)N * (N - 1) / 2 * value;
+      m_timed = false;
+      m_lastMs = 0;
+    }
+
+    void add(float value, unsigned long ms)
+    {
+      unsigned long steps = 1;
+      if (m_timed) steps = (ms - m_lastMs + m_sampleIntervalMs / 2) / m_sampleIntervalMs;
+      if (steps >= (unsigned long)N)
+      {
+        reset(value);
+      }
+      else
+      {
+        float last = m_samples[m_next > 0 ? m_next - 1 : N - 1];
+        for (unsigned long i = 1; i < steps; i++) add(last + (value - last) * i / steps);
+        add(value);   // steps 0, earlier than due: the next sample all the same
+      }
+      m_timed = true;
+      m_lastMs = ms;
+    }
+
+    void add(float value)
+    {
+      double oldest = m_samples[m_next];
+      m_sumXY += (N - 1) * (double)value - (m_sumY - oldest);
+      m_sumY += (double)value - oldest;
+      m_samples[m_next] = value;
+      m_next = m_next + 1 < N ? m_next + 1 : 0;
+    }
+
+    // slope in units per second
+    double slope() const
+    {
+      return (12 * m_sumXY - 6.0 * (N - 1) * m_sumY) / ((double)N * ((double)N * N - 1)) / m_sampleIntervalS;
+    }
+
+  private:
+    float m_samples[N];
+    int m_next;              // index of the oldest sample, overwritten next
+    double m_sumY, m_sumXY;
+    unsigned long m_sampleIntervalMs;
+    double m_sampleIntervalS;
+    bool m_timed;            // m_lastMs is set
+    unsigned long m_lastMs;  // time of the last timed sample
+};
+#endif
@@ -0,0 +1,49 @@
+#ifndef Snapshot_h
+#define Snapshot_h
+
+#include <stdint.h>
+
+/********************************************************
+  Snapshot: one writer publishes a value, readers (ISR,
+  other core) always get a complete copy, never a mix of
+  an old and a new value.
+
+  Double buffer with a sequence number: the writer fills
+  the buffer the readers do not use and then bumps the
+  sequence. A reader retries if the sequence changed while
+  it copied. An ISR on the writer's core never retries,
+  because the writer cannot run while the ISR does.
+******************************************************/
+template <typename T>
+class Snapshot
+{
+  public:
+    Snapshot() : m_buffer(), m_sequence(0) {}
+
+    __attribute__((always_inline)) inline void write(const T& value)
+    {
+      uint32_t next = m_sequence + 1;
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+      m_buffer[next & 1] = value;
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+      m_sequence = next;
+    }
+
+    __attribute__((always_inline)) inline T read() const
+    {
+      T value;
+      uint32_t sequence;
+      do {
+        sequence = m_sequence;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        value = m_buffer[sequence & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      } while (sequence != m_sequence);
+      return value;
+    }
+
+  private:
+    T m_buffer[2];
+    volatile uint32_t m_sequence;
+};
+#endif
@@ -0,0 +1,97 @@
+#ifndef StateEngine_h
+#define StateEngine_h
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/********************************************************
+  StateEngine: table driven state machine
+
+  The transitions are a constant table of rows
+      { from, to, priority, guard, action }
+  from is a bit set of states (see the bit function passed
+  to the constructor). step() looks at the rows leaving
+  the current state once and takes the one with the
+  highest priority whose guard holds, the first row wins
+  on equal priority. The row's action runs before the
+  state changes, the onTransition hook after it.
+
+  The last TraceSize transitions are kept in a ring for
+  the debug console.
+******************************************************/
+template <typename State, int TraceSize>
+class StateEngine
+{
+  public:
+    struct Transition {
+      uint32_t from;          // bit set of the states this row leaves
+      State to;
+      uint8_t priority;       // higher wins
+      bool (*guard)();
+      void (*action)();       // may be NULL
+    };
+
+    struct TraceEntry {
+      unsigned long ms;
+      State from, to;
+      uint8_t row;
+    };
+
+    StateEngine(State& state, const Transition* table, int count, uint32_t (*bit)(State),
+                void (*onTransition)(State from, State to))
+      : m_state(state), m_table(table), m_count(count), m_bit(bit),
+        m_onTransition(onTransition), m_traceNext(0), m_traceLength(0)
+    {
+    }
+
+    // one evaluation of the table, true if the state changed
+    bool step()
+    {
+      uint32_t current = m_bit(m_state);
+      int best = -1;
+      for (int i = 0; i < m_count; i++)
+      {
+        const Transition& t = m_table[i];
+        if (!(t.from & current)) continue;
+        if (best >= 0 && t.priority <= m_table[best].priority) continue;
+        if (t.guard()) best = i;
+      }
+      if (best < 0) return false;
+
+      const Transition& t = m_table[best];
+      State from = m_state;
+      if (t.action) t.action();
+      m_state = t.to;
+
+      TraceEntry& e = m_trace[m_traceNext];
+      e.ms = millis();
+      e.from = from;
+      e.to = t.to;
+      e.row = best;
+      m_traceNext = (m_traceNext + 1) % TraceSize;
+      if (m_traceLength < TraceSize) m_traceLength++;
+
+      if (m_onTransition) m_onTransition(from, t.to);
+      return true;
+    }
+
+    int traceLength() const { return m_traceLength; }
+
+    // i = 0 is the oldest stored transition
+    const TraceEntry& trace(int i) const
+    {
+      return m_trace[(m_traceNext - m_traceLength + i + TraceSize) % TraceSize];
+    }
+
+  private:
+    State& m_state;
+    const Transition* m_table;
+    int m_count;
+    uint32_t (*m_bit)(State);
+    void (*m_onTransition)(State from, State to);
+
+    TraceEntry m_trace[TraceSize];
+    int m_traceNext;
+    int m_traceLength;
+};
+#endif
@@ -0,0 +1,74 @@
+#include "TempObserver.h"
+
+#include <Arduino.h>
+
+// standard deviation of a sensor reading, C
+static const float readingNoise = 0.05;
+// process noise per second: boiler temperature (C) and heat flow (C/s)
+static const float boilerNoise = 0.01;
+static const float flowNoise = 0.02;
+
+TempObserver::TempObserver(float heaterPowerW, float boilerCapJK, float lossWK, float sensorTauS,
+                           float ambientC)
+{
+    m_heaterRate = heaterPowerW / boilerCapJK;
+    m_lossRate   = lossWK / boilerCapJK;
+    m_sensorTauS = sensorTauS;
+    m_ambientC   = ambientC;
+    reset(ambientC);
+}
+
+void TempObserver::reset(float reading)
+{
+    m_x[0] = m_x[1] = reading;
+    m_x[2] = 0;
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) m_p[i][j] = 0;
+    m_p[0][0] = 1;
+    m_p[1][1] = readingNoise * readingNoise;
+    m_p[2][2] = 0.01;
+    m_duty   = 0;
+    m_lastMs = millis();
+}
+
+void TempObserver::update(float reading, float heaterDuty)
+{
+    unsigned long now = millis();
+    float dt = (now - m_lastMs) / 1000.0;
+    m_lastMs = now;
+
+    // predict with the duty of the interval that just ended
+    float a = dt / m_sensorTauS;
+    if (a > 1) a = 1;
+    float tb = m_x[0], ts = m_x[1], d = m_x[2];
+    m_x[0] = tb + dt * (m_heaterRate * m_duty - m_lossRate * (tb - m_ambientC) + d);
+    m_x[1] = ts + a * (tb - ts);
+    m_duty = heaterDuty;
+
+    // P = F P F' + Q, F = [[1 - l dt, 0, dt], [a, 1 - a, 0], [0, 0, 1]]
+    float f[3][3] = {{1 - m_lossRate * dt, 0, dt}, {a, 1 - a, 0}, {0, 0, 1}};
+    float fp[3][3];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            fp[i][j] = f[i][0] * m_p[0][j] + f[i][1] * m_p[1][j] + f[i][2] * m_p[2][j];
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            m_p[i][j] = fp[i][0] * f[j][0] + fp[i][1] * f[j][1] + fp[i][2] * f[j][2];
+    m_p[0][0] += boilerNoise * boilerNoise * dt;
+    m_p[2][2] += flowNoise * flowNoise * dt;
+
+    // measurement of Ts, H = [0, 1, 0]
+    float s = m_p[1][1] + readingNoise * readingNoise;
+    float k[3] = {m_p[0][1] / s, m_p[1][1] / s, m_p[2][1] / s};
+    float innovation = reading - m_x[1];
+    for (int i = 0; i < 3; i++) m_x[i] += k[i] * innovation;
+
+    float row[3] = {m_p[1][0], m_p[1][1], m_p[1][2]};
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++) m_p[i][j] -= k[i] * row[j];
+}
+
+float TempObserver::rate() const
+{
+    return m_heaterRate * m_duty - m_lossRate * (m_x[0] - m_ambientC) + m_x[2];
+}
@@ -0,0 +1,46 @@
+#ifndef TempObserver_h
+#define TempObserver_h
+
+/********************************************************
+  Kalman filter for the boiler temperature
+
+  States: boiler temperature Tb, sensor temperature Ts and
+  an unknown heat flow d (C/s, water drawn during a shot,
+  model errors). Per reading, dt seconds apart:
+      Tb' = Tb + dt * (g u - l (Tb - ambient) + d)
+      Ts' = Ts + dt / tau * (Tb - Ts)
+      d'  = d
+  g = heater power / boiler heat capacity, u = heater duty
+  (0..1), l = loss / heat capacity. Only Ts is measured.
+
+  temperature() is Tb, it leads the sensor by about tau
+  and carries less noise than the reading. rate() is the
+  model slope of Tb in C/s.
+******************************************************/
+
+class TempObserver
+{
+  public:
+    TempObserver(float heaterPowerW, float boilerCapJK, float lossWK, float sensorTauS,
+                 float ambientC);
+
+    void reset(float reading);
+    void update(float reading, float heaterDuty);
+
+    float temperature() const { return m_x[0]; }
+    float sensorTemperature() const { return m_x[1]; }
+    float disturbance() const { return m_x[2]; }  // C/s
+    float rate() const;                            // C/s
+
+  private:
+    float m_heaterRate;  // C/s at full heater power
+    float m_lossRate;    // 1/s
+    float m_sensorTauS;
+    float m_ambientC;
+    float m_duty;        // heater duty since the last reading
+
+    unsigned long m_lastMs;
+    float m_x[3];
+    float m_p[3][3];
+};
+#endif
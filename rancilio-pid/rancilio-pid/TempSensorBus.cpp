@@ -0,0 +1,113 @@
+#include "TempSensorBus.h"
+
+#include <Arduino.h>
+
+TempSensorBus::TempSensorBus(DallasTemperature& bus) : m_bus(bus)
+{
+    m_count = 0;
+    m_next = 0;
+    m_state = kReady;
+    m_conversionMs = 0;
+    m_startMs = 0;
+    m_setMs = 0;
+}
+
+uint8_t TempSensorBus::begin(uint8_t maxCount, uint8_t resolution)
+{
+    m_bus.begin();
+    uint8_t found = m_bus.getDeviceCount();
+    if (found > maxCount) found = maxCount;
+    if (found > maxSensors) found = maxSensors;
+
+    m_count = 0;
+    while (m_count < found && m_bus.getAddress(m_sensors[m_count].address, m_count))
+    {
+        Sensor& s = m_sensors[m_count];
+        m_bus.setResolution(s.address, resolution);
+        s.celsius = DEVICE_DISCONNECTED_C;
+        s.valid = false;
+        s.readings = s.failures = s.failedInRow = 0;
+        m_count++;
+    }
+    m_conversionMs = m_bus.millisToWaitForConversion(resolution);
+
+    m_bus.setWaitForConversion(true);
+    m_bus.requestTemperatures();
+    for (uint8_t i = 0; i < m_count; i++) read(i);
+    m_setMs = millis();
+    m_state = kReady;
+    m_bus.setWaitForConversion(false);  // from now on poll() collects
+    return m_count;
+}
+
+void TempSensorBus::convert()
+{
+    if (m_count == 0) return;
+    m_bus.requestTemperatures();
+    m_startMs = millis();
+    m_state = kConverting;
+}
+
+void TempSensorBus::poll()
+{
+    switch (m_state)
+    {
+        case kConverting:
+            // ask the bus only once the datasheet time is over
+            if (millis() - m_startMs < m_conversionMs || !m_bus.isConversionComplete()) return;
+            m_next = 0;
+            m_state = kReading;
+            // fall through, read the first sensor in this pass
+        case kReading:
+            read(m_next++);
+            if (m_next < m_count) return;
+            m_setMs = millis();
+            m_state = kReady;
+            return;
+
+        case kReady:
+            return;
+    }
+}
+
+void TempSensorBus::read(uint8_t i)
+{
+    Sensor& s = m_sensors[i];
+    float celsius = m_bus.getTempC(s.address);
+    s.readings++;
+    s.valid = celsius != DEVICE_DISCONNECTED_C;
+    if (s.valid)
+    {
+        s.celsius = celsius;
+        s.failedInRow = 0;
+    }
+    else
+    {
+        s.failures++;
+        s.failedInRow++;
+    }
+}
+
+bool TempSensorBus::mix(const float* weights, float& celsius) const
+{
+    float sum = 0, total = 0;
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        if (weights[i] <= 0) continue;
+        if (!m_sensors[i].valid) return false;
+        sum += weights[i] * m_sensors[i].celsius;
+        total += weights[i];
+    }
+    if (total <= 0) return false;
+    celsius = sum / total;
+    return true;
+}
+
+void TempSensorBus::resetStats()
+{
+    for (uint8_t i = 0; i < m_count; i++)
+    {
+        m_sensors[i].readings = 0;
+        m_sensors[i].failures = 0;
+    }
+}
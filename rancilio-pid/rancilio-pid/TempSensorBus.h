@@ -0,0 +1,78 @@
+#ifndef TempSensorBus_h
+#define TempSensorBus_h
+
+#include <DallasTemperature.h>
+
+/********************************************************
+  TempSensorBus: all DS18B20 on one OneWire bus (boiler,
+  group head, steam boiler)
+
+  One conversion for all sensors (skip ROM), then poll()
+  reads one scratchpad per call (about 12 ms of bus time
+  each), so a loop pass pays for one sensor and not for
+  all of them:
+
+      convert() -> converting -> reading 0..n-1 -> ready
+
+  The caller takes the set once ready() and starts the
+  next one with convert().
+
+  Sensors are numbered in bus search order, which only
+  changes when a sensor is added or replaced. A reading
+  is valid if the sensor answered with a good CRC, the
+  library returns DEVICE_DISCONNECTED_C otherwise; the
+  sensor then keeps its last valid temperature.
+
+  mix() is the weighted mean of the sensors with a weight
+  > 0. It fails if one of them has no valid reading, the
+  others never shift the result.
+******************************************************/
+class TempSensorBus
+{
+  public:
+    static const uint8_t maxSensors = 4;
+
+    struct Sensor {
+      DeviceAddress address;
+      float celsius;          // last valid reading
+      bool valid;             // the last reading was valid
+      uint32_t readings;
+      uint32_t failures;
+      uint32_t failedInRow;
+    };
+
+    explicit TempSensorBus(DallasTemperature& bus);
+
+    // finds up to maxCount sensors and waits for their first
+    // conversion, returns the number of sensors
+    uint8_t begin(uint8_t maxCount, uint8_t resolution);
+
+    void poll();
+    bool ready() const { return m_count > 0 && m_state == kReady; }
+    void convert();
+    bool mix(const float* weights, float& celsius) const;
+
+    uint8_t count() const { return m_count; }
+    const Sensor& sensor(uint8_t i) const { return m_sensors[i]; }
+    unsigned long setMs() const { return m_setMs; }  // millis() of the last complete set
+    void resetStats();
+
+  private:
+    enum State {
+      kConverting,
+      kReading,
+      kReady,
+    };
+
+    void read(uint8_t i);
+
+    DallasTemperature& m_bus;
+    Sensor m_sensors[maxSensors];
+    uint8_t m_count;
+    uint8_t m_next;           // next sensor to read
+    State m_state;
+    unsigned long m_conversionMs;
+    unsigned long m_startMs;  // conversion started
+    unsigned long m_setMs;
+};
+#endif
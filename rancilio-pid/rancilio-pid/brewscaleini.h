@@ -4,6 +4,7 @@
 
 #if PINBREWSWITCH == 0
    const int analogPin = 0; // AI0 will be used 
+   AnalogSwitch brewSwitchInput(800, 400); // on above, off below (filtered reading)
 #endif
 
 /********************************************************
@@ -40,9 +41,16 @@ float calibrationValue = 3195.83; // use calibration example to get value
 float weight = 0;   // value from HX711
 float weightPreBrew = 0;  // value of scale before wrew started
 float weightBrew = 0;  // weight value of brew
-float scaleDelayValue = 2.5;  //value in gramm that takes still flows onto the scale after brew is stopped
+float flowRate = 0;  // g/s onto the scale
+float scaleStopLatency = SCALESTOPLATENCY;  // s of flow that still reaches the scale after brew is stopped, learned per shot
+float weightAtStop = 0;  // weightBrew when the brew was stopped by weight
+float flowAtStop = 0;
+unsigned long stopMillis = 0;  // 0 = no stop to learn from
+const unsigned long scaleSettleTime = 6000;  // ms until the drip after a stop is in the cup
+const unsigned long intervalFlow = 100;  // flow rate sample interval, 10 samples = 1 s window
+SlopeEstimator<10> flowEstimator(intervalFlow);
 bool scaleFailure = false;
-const unsigned long intervalWeight = 200;   // weight scale
-unsigned long previousMillisScale;  // initialisation at the end of init()
+unsigned long weightSamples = 0;  // HX711 samples when weight was last updated
+const unsigned long intervalWeight = SCALEINTERRUPT == 1 ? 0 : 200;   // weight scale, 0 = every pass, only takes new samples
 HX711_ADC LoadCell(HXDATPIN, HXCLKPIN);
 #endif
\ No newline at end of file
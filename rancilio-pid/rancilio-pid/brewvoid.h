@@ -17,13 +17,16 @@ void checkbrewswitch()
       if (currentMillistemp - previousMillistempanalogreading >= analogreadingtimeinterval)
       {
         previousMillistempanalogreading = currentMillistemp;
-        if (filter(analogRead(analogPin)) > 1000 )
+        switch (brewSwitchInput.sample(analogRead(analogPin)))
         {
-          brewswitch = HIGH ; 
-        }
-        if (filter(analogRead(analogPin)) < 1000 )
-        {
-          brewswitch = LOW ;
+          case AnalogSwitch::kOn:
+            brewswitch = HIGH ;
+            break;
+          case AnalogSwitch::kOff:
+            brewswitch = LOW ;
+            break;
+          default:
+            break;
         }
       }
     #endif
@@ -57,13 +60,16 @@ void checkbrewswitch()
         {
           //DEBUG_println(analogRead(analogPin));
           previousMillistempanalogreading = currentMillistemp;
-          if (filter(analogRead(analogPin)) > 1000 )
+          switch (brewSwitchInput.sample(analogRead(analogPin)))
           {
-            brewswitchTrigger = HIGH ; 
-          }
-          if (filter(analogRead(analogPin)) < 1000 )
-          {
-            brewswitchTrigger = LOW ;
+            case AnalogSwitch::kOn:
+              brewswitchTrigger = HIGH ;
+              break;
+            case AnalogSwitch::kOff:
+              brewswitchTrigger = LOW ;
+              break;
+            default:
+              break;
           }
         }
     #endif
@@ -374,7 +380,11 @@ void brew()
         brewcounter = 41;
         break;
       case 41:    //waiting time brew
-        if (bezugsZeit > totalbrewtime || (weightBrew > (weightSetpoint - scaleDelayValue))) {
+        // stop when what still flows after the stop makes the setpoint
+        if (weightBrew + (flowRate > 0 ? flowRate : 0) * scaleStopLatency >= weightSetpoint) {
+          weightAtStop = weightBrew;
+          flowAtStop = flowRate;
+          stopMillis = millis();
           brewcounter = 42;
         }
         if (bezugsZeit > totalbrewtime) {
@@ -404,3 +414,35 @@ void brew()
   }
 }
 #endif
+
+
+/********************************************************
+    Feed-forward at shot start
+    The water drawn during a shot needs flow * c * (setpoint - inlet)
+    of heater power. As soon as the brew is known (brew switch or
+    voltage sensor) this is added to the PID output, decaying with
+    FEEDFORWARDTIME, so the boiler heats before the PID sees a dip.
+******************************************************/
+void brewFeedForward()
+{
+  #if (FEEDFORWARD == 1)
+  static unsigned long feedForwardStart = 0;
+  static boolean feedForwardActive = false;
+
+  if (machinestate != kBrew || (ONLYPID == 1 && Brewdetection != 3))  // software brewdetection is too late
+  {
+    feedForwardActive = false;
+    feedForward = 0;
+    return;
+  }
+  if (!feedForwardActive)
+  {
+    feedForwardActive = true;
+    feedForwardStart = millis();
+  }
+
+  double power = BREWFLOW * 4.186 * (BrewSetPoint - INLETTEMP);  // W, 4.186 J/(g K) water
+  double t = (millis() - feedForwardStart) / 1000.0;
+  feedForward = windowSize * power / HEATERPOWER * exp(-t / FEEDFORWARDTIME);
+  #endif
+}
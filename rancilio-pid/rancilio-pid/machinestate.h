@@ -0,0 +1,369 @@
+/********************************************************
+  Machine state engine
+
+  The transitions between the machine states are the
+  constant table machineTransitions below, evaluated once
+  per loop by StateEngine. A row leaves every state in its
+  from set; of the rows whose guard holds the one with the
+  highest priority wins:
+
+    kPrioSensorError > kPrioPidOff > kPrioEmergency >
+    kPrioBackflush > kPrioSteam > kPrioBrew > kPrioState
+
+  kPrioState is the regular progress of a state (cold
+  start done, brew finished, ...). Work done while staying
+  in a state (brew detection, cold start timer) is in
+  machinestateActivity(), everything that belongs to a
+  change of state (PID tunings, autotune, log) in
+  machinestateTransition().
+******************************************************/
+
+#include "StateEngine.h"
+
+enum TransitionPriority {
+  kPrioState = 1,
+  kPrioBrew,
+  kPrioSteam,
+  kPrioBackflush,
+  kPrioEmergency,
+  kPrioPidOff,
+  kPrioSensorError,
+};
+
+constexpr MachineState machineStates[] = {
+  kInit, kColdStart, kSetPointNegative, kPidNormal, kBrew, kShotTimerAfterBrew, kBrewDetectionTrailing,
+  kSteam, kCoolDown, kBackflush, kAutotune, kEmergencyStop, kPidOffline, kSensorError,
+};
+
+constexpr uint32_t stateBitFrom(MachineState state, unsigned int i)
+{
+  return i >= sizeof(machineStates) / sizeof(machineStates[0]) ? 0
+       : machineStates[i] == state ? 1UL << i
+       : stateBitFrom(state, i + 1);
+}
+
+constexpr uint32_t stateBit(MachineState state) { return stateBitFrom(state, 0); }
+
+uint32_t machineStateBit(MachineState state) { return stateBit(state); }
+
+// states with the same exits
+constexpr uint32_t kHeatingStates = stateBit(kColdStart) | stateBit(kSetPointNegative);
+constexpr uint32_t kBrewStates = stateBit(kBrew) | stateBit(kShotTimerAfterBrew) | stateBit(kBrewDetectionTrailing);
+constexpr uint32_t kAllStates = (1UL << (sizeof(machineStates) / sizeof(machineStates[0]))) - 1;
+
+/********************************************************
+  Guards
+******************************************************/
+bool brewStarted()
+{
+  return (bezugsZeit > 0 && ONLYPID == 1) ||                     // Bezugszeit bei Only PID
+         (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42);
+}
+
+bool brewRestarted()  // new brew inside BD only by Only PID AND voltage sensor
+{
+  return (bezugsZeit > 0 && ONLYPID == 1 && Brewdetection == 3) ||
+         (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42);
+}
+
+bool brewEnded()
+{
+  return (bezugsZeit > 35*1000 && Brewdetection == 1 && ONLYPID == 1) ||  // 35 sec later and BD PID active SW Solution
+         (bezugsZeit == 0      && Brewdetection == 3 && ONLYPID == 1) ||  // Voltagesensor reset bezugsZeit == 0
+         ((brewcounter == 10 || brewcounter == 43) && ONLYPID == 0);      // After brew
+}
+
+// only delay of shotimer for voltagesensor or brewcounter
+bool brewEndedShotTimer() { return brewEnded() && ((ONLYPID == 1 && Brewdetection == 3) || ONLYPID == 0); }
+bool brewEndedDetection() { return brewEnded() && ONLYPID == 1 && Brewdetection == 1 && timerBrewdetection == 1; }
+bool shotTimerDone() { return millis() - lastbezugszeitMillis > BREWSWITCHDELAY; }
+bool brewDetectionDone() { return timerBrewdetection == 0; }
+
+bool coldStartLeft() { return Input < (BrewSetPoint-1) || Input < 150; }  // Prevent coldstart leave by Input 222
+bool coldStartDone() { return machinestatecold == 10 && millis() - machinestatecoldmillis > 10*1000; }
+bool setPointReached() { return Input >= BrewSetPoint; }
+
+bool coolDownDone()
+{
+  // Ab lokalen Minumum wieder freigeben für state 20, dann wird bist Solltemp geheizt.
+  if (Brewdetection == 1 && ONLYPID == 1) return heatrateaverage > 0 && Input < BrewSetPoint + 2;
+  return (Brewdetection == 3 || Brewdetection == 2) && Input < BrewSetPoint + 2;
+}
+
+bool steamOn() { return SteamON == 1; }
+bool steamOff() { return SteamON == 0; }
+bool backflushActive() { return backflushON || backflushState > 10; }
+bool backflushDone() { return backflushON == 0; }
+bool emergencyActive() { return emergencyStop; }
+bool emergencyCleared() { return !emergencyStop; }
+bool pidOff() { return pidON == 0; }
+bool sensorFailed() { return sensorError; }
+bool autotuneRequested() { return autotuneON == 1; }
+bool autotuneDone() { return autotune.state() == Autotune::kDone; }
+bool autotuneAborted() { return autotune.state() == Autotune::kFailed || autotuneON == 0; }
+
+// back from offline: cold start if it never ended or Input is 10C below set point
+bool pidOnCold() { return pidON == 1 && (kaltstart || Input <= (BrewSetPoint-10)); }
+bool pidOnWarm() { return pidON == 1 && !kaltstart && Input > (BrewSetPoint-10); }
+
+/********************************************************
+  Actions
+******************************************************/
+void startAutotune()
+{
+  autotune.start(BrewSetPoint, AUTOTUNE_OUTPUT, 0, AUTOTUNE_HYSTERESIS, 3600UL * 1000);
+  debugStream.writeI("autotune: start, heater %i/%i ms around %.1f C", AUTOTUNE_OUTPUT, windowSize, BrewSetPoint);
+}
+
+void finishAutotune()
+{
+  autotuneApply();
+  autotuneON = 0;
+}
+
+void abortAutotune()
+{
+  debugStream.writeW("autotune: aborted after %i cycles", autotune.cycles());
+  autotune.stop();
+  autotuneON = 0;
+}
+
+void startShotTimer() { lastbezugszeitMillis = millis(); }  // for delay
+
+void endShotTimer()
+{
+  debugStream.writeI("Bezugsdauer: %4.1f s", lastbezugszeit/1000);
+  lastbezugszeit = 0;
+}
+
+void enterColdStart() { kaltstart = true; }
+
+typedef StateEngine<MachineState, 16> MachineEngine;
+
+constexpr MachineEngine::Transition machineTransitions[] = {
+  // regular progress
+  { stateBit(kInit),                   kColdStart,             kPrioState, coldStartLeft, NULL },
+  { stateBit(kColdStart),              kSetPointNegative,      kPrioState, coldStartDone, NULL },
+  { stateBit(kSetPointNegative),       kPidNormal,             kPrioState, setPointReached, NULL },
+  { stateBit(kPidNormal),              kAutotune,              kPrioState, autotuneRequested, startAutotune },
+  { stateBit(kBrew),                   kShotTimerAfterBrew,    kPrioState, brewEndedShotTimer, startShotTimer },
+  { stateBit(kBrew),                   kBrewDetectionTrailing, kPrioState, brewEndedDetection, NULL },
+  { stateBit(kShotTimerAfterBrew),     kBrewDetectionTrailing, kPrioState, shotTimerDone, endShotTimer },
+  { stateBit(kBrewDetectionTrailing),  kPidNormal,             kPrioState, brewDetectionDone, NULL },
+  { stateBit(kSteam),                  kCoolDown,              kPrioState, steamOff, NULL },
+  { stateBit(kCoolDown),               kPidNormal,             kPrioState, coolDownDone, NULL },
+  { stateBit(kBackflush),              kPidNormal,             kPrioState, backflushDone, NULL },
+  { stateBit(kAutotune),               kPidNormal,             kPrioState, autotuneDone, finishAutotune },
+  { stateBit(kAutotune),               kPidNormal,             kPrioState, autotuneAborted, abortAutotune },
+  { stateBit(kEmergencyStop),          kPidNormal,             kPrioState, emergencyCleared, NULL },
+  { stateBit(kPidOffline),             kColdStart,             kPrioState, pidOnCold, enterColdStart },
+  { stateBit(kPidOffline),             kPidNormal,             kPrioState, pidOnWarm, NULL },
+
+  // user requests
+  { kHeatingStates | stateBit(kPidNormal) | stateBit(kAutotune),
+                                       kBrew,                  kPrioBrew, brewStarted, NULL },
+  { stateBit(kBrewDetectionTrailing),  kBrew,                  kPrioBrew, brewRestarted, NULL },
+  { kHeatingStates | kBrewStates | stateBit(kCoolDown) | stateBit(kAutotune),
+                                       kSteam,                 kPrioSteam, steamOn, NULL },
+  { kHeatingStates | stateBit(kPidNormal) | stateBit(kShotTimerAfterBrew) | stateBit(kBrewDetectionTrailing) |
+    stateBit(kSteam) | stateBit(kCoolDown) | stateBit(kAutotune),
+                                       kBackflush,             kPrioBackflush, backflushActive, NULL },
+
+  // safety
+  { stateBit(kPidNormal) | kBrewStates | stateBit(kSteam) | stateBit(kCoolDown) | stateBit(kBackflush) |
+    stateBit(kAutotune),
+                                       kEmergencyStop,         kPrioEmergency, emergencyActive, NULL },
+  { kAllStates & ~(stateBit(kPidOffline) | stateBit(kSensorError)),
+                                       kPidOffline,            kPrioPidOff, pidOff, NULL },
+  { kAllStates & ~stateBit(kSensorError),
+                                       kSensorError,           kPrioSensorError, sensorFailed, NULL },
+};
+
+/********************************************************
+  PID tunings of a state, applied on every change of
+  state and when a gain was changed (pidTuningsChanged)
+******************************************************/
+void setPidTunings(MachineState state)
+{
+  switch (state)
+  {
+    // Cold Start states
+    case kInit:
+    case kColdStart:
+    case kSetPointNegative:
+      if (startTn != 0) {
+        startKi = startKp / startTn;
+      } else {
+        startKi = 0 ;
+      }
+      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",startKp,startKi,0);
+      bPID.SetTunings(startKp, startKi, 0, P_ON_M);
+    break;
+
+    // normal PID
+    case kPidNormal:
+      if (aggTn != 0) {
+        aggKi = aggKp / aggTn ;
+      } else {
+        aggKi = 0 ;
+      }
+      aggKd = aggTv * aggKp ;
+      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggKp,aggKi,aggKd);
+      bPID.SetTunings(aggKp, aggKi, aggKd, PonE);
+      kaltstart = false;
+    break;
+
+    // BD PID
+    case kBrew:
+    case kShotTimerAfterBrew:
+    case kBrewDetectionTrailing:
+      if (aggbTn != 0) {
+        aggbKi = aggbKp / aggbTn ;
+      } else {
+        aggbKi = 0 ;
+      }
+      aggbKd = aggbTv * aggbKp ;
+      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggbKp,aggbKi,aggbKd);
+      bPID.SetTunings(aggbKp, aggbKi, aggbKd, PonE) ;
+    break;
+
+    case kSteam:
+      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",150,0,0);
+      bPID.SetTunings(150, 0, 0, PonE);
+    break;
+
+    // chill-mode after steam
+    case kCoolDown:
+      switch (machine) {
+        case QuickMill:
+          aggbKp = 150;
+          aggbKi = 0;
+          aggbKd = 0;
+        break;
+
+        default:
+          if (aggbTn != 0) {
+            aggbKi = aggbKp / aggbTn;
+          } else {
+            aggbKi = 0;
+          }
+          aggbKd = aggbTv * aggbKp;
+      }
+      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggbKp,aggbKi,aggbKd);
+      bPID.SetTunings(aggbKp, aggbKi, aggbKd, PonE) ;
+    break;
+
+    // sensor error, emergency stop, offline, backflush, autotune: keep the tunings
+    default:
+    break;
+  }
+  pidTuningsChanged = false;
+}
+
+void machinestateTransition(MachineState from, MachineState to)
+{
+  debugStream.writeI("new machinestate: %i -> %i", from, to);
+
+  // leaving autotune for any other reason ends the experiment
+  if (from == kAutotune)
+  {
+    if (autotune.state() == Autotune::kRunning)
+    {
+      debugStream.writeW("autotune: interrupted by machinestate %i", to);
+      autotune.stop();
+      autotuneON = 0;
+    }
+    if (Blynk.connected())
+    {
+      Blynk.virtualWrite(V41, 0);
+    }
+  }
+
+  if (to == kColdStart)
+  {
+    machinestatecold = 0;
+  }
+  setPidTunings(to);
+}
+
+MachineEngine machineEngine(machinestate, machineTransitions,
+                            sizeof(machineTransitions) / sizeof(machineTransitions[0]),
+                            machineStateBit, machinestateTransition);
+
+/********************************************************
+  Work done while staying in a state
+******************************************************/
+void machinestateActivity()
+{
+  switch (machinestate)
+  {
+    case kColdStart:
+      // one high Input let the state jump to 19.
+      // switch (machinestatecold) prevent it, we wait 10 sec with new state.
+      // during the 10 sec the Input has to be Input >= (BrewSetPoint-1),
+      // If not, reset machinestatecold
+      if (machinestatecold == 0 && Input >= (BrewSetPoint-1) && Input < 150)
+      {
+        machinestatecoldmillis = millis(); // get millis for interval calc
+        machinestatecold = 10 ; // new state
+        debugStream.writeV("Input >= (BrewSetPoint-1), wait 10 sec before machinestate 19");
+      }
+      else if (machinestatecold == 10 && Input < (BrewSetPoint-1))
+      {
+        machinestatecold = 0 ;//  Input was only one time above BrewSetPoint, reset machinestatecold
+        debugStream.writeV("Reset timer for machinestate 19: Input < (BrewSetPoint-1)");
+      }
+    break;
+
+    case kBrew:
+      brewdetection();
+      // Ausgabe waehrend des Bezugs von Bruehzeit, Temp und heatrateaverage
+      if (logbrew.check())
+          debugStream.writeV("(tB,T,hra) --> %5.2f %6.2f %8.2f",(double)(millis() - startZeit)/1000,Input,heatrateaverage);
+    break;
+
+    case kPidNormal:
+    case kShotTimerAfterBrew:
+    case kBrewDetectionTrailing:
+      brewdetection();  //if brew detected, set PID values
+    break;
+
+    case kCoolDown:
+      if (Brewdetection == 2 || Brewdetection == 3)
+      {
+        /*
+          Bei QuickMill Dampferkennung nur ueber Bezugsschalter moeglich, durch Aufruf von
+          brewdetection() kann neuer Dampfbezug erkannt werden
+          */
+        brewdetection();
+      }
+    break;
+
+    default:
+    break;
+  }
+}
+
+void machinestatevoid()
+{
+  PROFILE_SCOPE(profileMachine);
+  machinestateActivity();
+  machineEngine.step();
+}
+
+/********************************************************
+  Debug console: statetrace
+******************************************************/
+#if (DEBUGMETHOD == 1 || DEBUGMETHOD == 2)
+void printStateTrace()
+{
+  debugA("");
+  debugA(" *** last %i machine state transitions ***", machineEngine.traceLength());
+  for (int i = 0; i < machineEngine.traceLength(); i++)
+  {
+    const MachineEngine::TraceEntry& e = machineEngine.trace(i);
+    debugA("t: %10.3f  %3i -> %3i  (row %i)", e.ms / 1000.0, e.from, e.to, e.row);
+  }
+  debugA("");
+}
+#endif
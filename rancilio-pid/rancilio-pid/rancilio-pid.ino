@@ -13,7 +13,11 @@
 #include <EEPROM.h>
 #include "userConfig.h" // needs to be configured by the user
 #include <U8g2lib.h>
-#include "PID_v1.h" //for PID calculation
+#if (PID_FIXEDPOINT == 1)
+  #include "PID_fixed.h" //for PID calculation, integer only
+#else
+  #include "PID_v1.h" //for PID calculation
+#endif
 #include "languages.h" // for language translation
 #include <DallasTemperature.h>    //Library for dallas temp sensor
 #if defined(ESP8266) 
@@ -66,9 +70,81 @@ MACHINE machine = (enum MACHINE) MACHINEID;
 DebugStreamManager debugStream;
 
 #include "PeriodicTrigger.h" // Trigger, der alle x Millisekunden auf true schaltet
+#include "Autotune.h"        // relay feedback autotune for the PID gain sets
+#include "SlopeEstimator.h"  // heat rate for the brew detection
+#include "TempObserver.h"    // boiler temperature estimate for the PID (TEMPOBSERVER)
+#include "Scheduler.h"       // periodic jobs of loop()
+#include "Profiler.h"        // run time of the loop stages (PROFILER)
+#include "ConnectionManager.h" // non-blocking reconnects of WiFi, Blynk and MQTT
+#include "ServerProbe.h"       // DNS lookup and TCP handshake before a connect
+#include "TempSensorBus.h"   // all DS18B20 on the OneWire bus (TEMPSENSOR 1)
+#include "SensorFilter.h"    // Hampel filter, sensor fault detection
+#include "AdcDecimator.h"    // oversampled pressure readings (PRESSURESENSOR)
+#include "PulseTrain.h"      // pump bursts from the voltage sensor edges (BREWDETECTION 3)
+#include "AnalogSwitch.h"    // brew switch on the ADC (PINBREWSWITCH 0)
+#include "Deadband.h"        // change-only telemetry (TELEMETRYDEADBAND)
 PeriodicTrigger writeDebugTrigger(5000); // trigger alle 5000 ms
 PeriodicTrigger logbrew(500);
 
+/********************************************************
+  Scheduler, the higher the priority the earlier a due
+  task runs. Network tasks give way to due control tasks.
+******************************************************/
+enum TaskPriority {
+  kTaskNetwork = 1,
+  kTaskInfo,
+  kTaskDisplay,
+  kTaskSensor,
+  kTaskControl,
+};
+Scheduler scheduler;
+
+/********************************************************
+  Profiler stages (PROFILER 1, console command "profile")
+******************************************************/
+PROFILE_STAGE(profileLoop, "looppid");
+PROFILE_STAGE(profileTemp, "refreshTemp");
+PROFILE_STAGE(profileScale, "checkWeight");
+PROFILE_STAGE(profileMachine, "machinestate");
+PROFILE_STAGE(profileControl, "controlTask");
+PROFILE_STAGE(profileDisplay, "printScreen");
+PROFILE_STAGE(profileBlynkSend, "sendToBlynk");
+PROFILE_STAGE(profileBlynkRun, "Blynk.run");
+PROFILE_STAGE(profileMqtt, "mqtt.loop");
+
+/********************************************************
+  Debug console: profile, the stages since the last call
+******************************************************/
+#if (PROFILER == 1 && (DEBUGMETHOD == 1 || DEBUGMETHOD == 2))
+void printProfile()
+{
+  debugA("");
+  debugA("     --- START profile START ---");
+  debugA("  stage               count    min us    avg us    max us");
+  for (ProfileStage* stage = ProfileStage::first(); stage; stage = stage->next())
+  {
+    debugA("  %-16s %8lu %9lu %9lu %9lu", stage->name(), (unsigned long)stage->count(),
+      (unsigned long)stage->minUs(), (unsigned long)stage->avgUs(), (unsigned long)stage->maxUs());
+  }
+  debugA("");
+  debugA("  histogram, calls per bucket: <2 us, <4 us, <8 us, ... >=%lu us", 1UL << (ProfileStage::buckets - 1));
+  for (ProfileStage* stage = ProfileStage::first(); stage; stage = stage->next())
+  {
+    char line[12 * ProfileStage::buckets + 1];
+    int n = 0;
+    for (int i = 0; i < ProfileStage::buckets; i++)
+    {
+      n += snprintf(line + n, sizeof(line) - n, " %lu", (unsigned long)stage->bucket(i));
+    }
+    debugA("  %-16s%s", stage->name(), line);
+    stage->reset();
+  }
+  debugA("");
+  debugA("     ---  END  profile  END  ---");
+  debugA("");
+}
+#endif
+
 /********************************************************
   Machine State
 ******************************************************/
@@ -84,6 +160,7 @@ enum MachineState {
     kSteam = 40,
     kCoolDown = 45,
     kBackflush = 50,
+    kAutotune = 60,
     kEmergencyStop = 80,
     kPidOffline = 90,
     kSensorError = 100,
@@ -91,8 +168,7 @@ enum MachineState {
 MachineState machinestate = kInit;
 int machinestatecold = 0;
 unsigned long  machinestatecoldmillis = 0;
-MachineState lastmachinestate = kInit;
-int lastmachinestatepid = -1;
+boolean pidTuningsChanged = true;  // a gain was changed, looppid() applies the tunings of the machine state
 
 /********************************************************
   definitions below must be changed in the userConfig.h file
@@ -112,6 +188,78 @@ const unsigned int maxWifiReconnects = MAXWIFIRECONNECTS;
 const unsigned long brewswitchDelay = BREWSWITCHDELAY;
 int BrewMode = BREWMODE;
 const char* sysVersion PROGMEM  = SYSVERSION_DISPLAY; //System version
+#ifndef AUTOTUNE_OUTPUT       // missing in userConfig.h of older versions
+#define AUTOTUNE_OUTPUT 300
+#endif
+#ifndef AUTOTUNE_HYSTERESIS
+#define AUTOTUNE_HYSTERESIS 0.2
+#endif
+#ifndef BREWDETECTIONWINDOW
+#define BREWDETECTIONWINDOW 15
+#endif
+#ifndef DS18B20RESOLUTION
+#define DS18B20RESOLUTION 10
+#endif
+#ifndef TEMPSENSORS
+#define TEMPSENSORS 1
+#endif
+#ifndef PVSMERGETIME
+#define PVSMERGETIME 30
+#endif
+#ifndef PVSBREWTIME
+#define PVSBREWTIME 200
+#endif
+#ifndef PVSSTEAMGAP
+#define PVSSTEAMGAP 1500
+#endif
+#ifndef TELEMETRYDEADBAND
+#define TELEMETRYDEADBAND 1
+#endif
+#ifndef TELEMETRYHEARTBEAT
+#define TELEMETRYHEARTBEAT 60
+#endif
+#ifndef MQTT_BATCH
+#define MQTT_BATCH 0
+#endif
+#ifndef TOFBUDGET
+#define TOFBUDGET 200000
+#endif
+#ifndef TOFPERIOD
+#define TOFPERIOD 1000
+#endif
+#ifndef TOFMEDIAN
+#define TOFMEDIAN 5
+#endif
+#ifndef PRESSURESAMPLETIME
+#define PRESSURESAMPLETIME 1
+#endif
+#ifndef PRESSUREDECIMATION
+#define PRESSUREDECIMATION 20
+#endif
+#ifndef SCALESTOPLATENCY
+#define SCALESTOPLATENCY 1.2
+#endif
+#ifndef SCALEINTERRUPT
+#define SCALEINTERRUPT 0
+#endif
+#ifndef SCALESAMPLES
+#define SCALESAMPLES 16
+#endif
+#if (SCALEINTERRUPT == 1 && HXDATPIN == 16)
+  #error("SCALEINTERRUPT needs a HXDATPIN with pin interrupt, GPIO16 has none");
+#endif
+#ifndef SENSORFILTERWINDOW
+#define SENSORFILTERWINDOW 7
+#endif
+#ifndef SENSORFILTERLIMIT
+#define SENSORFILTERLIMIT 3
+#endif
+#ifndef SENSORSTUCKTIME
+#define SENSORSTUCKTIME 300
+#endif
+#ifndef TEMPSENSORWEIGHTS
+#define TEMPSENSORWEIGHTS {1}
+#endif
 
 //Display
 uint8_t oled_i2c = OLED_I2C;
@@ -122,18 +270,35 @@ int calibration_mode = CALIBRATION_MODE;
 uint8_t tof_i2c = TOF_I2C;
 int water_full = WATER_FULL;
 int water_empty = WATER_EMPTY;
-unsigned long previousMillisTOF;  // initialisation at the end of init()
-const unsigned long intervalTOF = 5000 ; //ms
+unsigned long previousMillisTOF;  // calibration mode only
+const unsigned long intervalTOF = 100 ; //ms, poll for a finished range, the sensor ranges every TOFPERIOD ms on its own
 double distance;
 double percentage;
+SensorFilter<TOFMEDIAN> distanceFilter(0, 1000, 3, 2, 0);  // median of the last valid distances in mm
+unsigned long tofRanges = 0;   // ranges collected
+unsigned long tofInvalid = 0;  // without target or out of range
 
 // Wifi
 const char* hostname = HOSTNAME;
 const char* auth = AUTH;
 const char* ssid = D_SSID;
 const char* pass = PASS;
-unsigned long lastWifiConnectionAttempt = millis();
-unsigned int wifiReconnects = 0; //actual number of reconnects
+const unsigned long wifiConnectTimeout = 10000;   // ms per WiFi attempt
+
+/********************************************************
+  Network links, reconnected by networkTask() without
+  blocking the loop. A failed attempt is retried after
+  wifiConnectionDelay, after the boot doubling up to
+  maxConnectionBackoff.
+******************************************************/
+enum NetworkLink {
+  kLinkWifi,
+  kLinkBlynk,
+  kLinkMqtt,
+};
+const unsigned long maxConnectionBackoff = 300000; // ms
+ConnectionManager connection(wifiConnectionDelay, wifiConnectionDelay);
+const unsigned long serverProbeTimeout = 3000;     // ms for the lookup and the handshake of a probe
 
 // OTA
 const char* OTAhost = OTAHOST;
@@ -142,9 +307,10 @@ const char* OTApass = OTAPASS;
 //Blynk
 const char* blynkaddress  = BLYNKADDRESS;
 const int blynkport = BLYNKPORT;
-unsigned int blynkReCnctFlag;  // Blynk Reconnection Flag
-unsigned int blynkReCnctCount = 0;  // Blynk Reconnection counter
-unsigned long lastBlynkConnectionAttempt = millis();
+const unsigned long blynkConnectSlice = 10;       // ms Blynk.connect() may block, Blynk.run() does the rest
+const unsigned long blynkConnectTimeout = 5000;   // ms until the login has to be done
+ServerProbe blynkProbe(serverProbeTimeout);
+bool blynkLogin = false;                          // Blynk.run() may finish a login
 
 //backflush values
 const unsigned long fillTime = FILLTIME;
@@ -161,22 +327,28 @@ const char* mqtt_password = MQTT_PASSWORD;
 const char* mqtt_topic_prefix = MQTT_TOPIC_PREFIX;
 char topic_will[256];
 char topic_set[256];
-unsigned long lastMQTTConnectionAttempt = millis();
-unsigned int MQTTReCnctFlag;  // Blynk Reconnection Flag
-unsigned int MQTTReCnctCount = 0;  // Blynk Reconnection counter
+char mqtt_topic[120];                             // "<prefix><hostname>/", the reading is copied behind it
+size_t mqtt_topic_len = 0;
+#if MQTT_BATCH == 1
+char mqtt_batch[400];                             // JSON document of one sendToBlynk() call
+size_t mqtt_batch_len = 0;
+unsigned int mqtt_batch_dropped = 0;              // readings that did not fit
+#endif
+const uint16_t mqttSocketTimeout = 1;             // s, longest mqtt.connect() waits for the CONNACK
+const unsigned long mqttConnectTimeout = 5000;    // ms until the broker has to be connected
+ServerProbe mqttProbe(serverProbeTimeout);
 
 //Voltage Sensor
 unsigned long previousMillisVoltagesensorreading = millis();
 const unsigned long intervalVoltagesensor= 200 ;
 int VoltageSensorON, VoltageSensorOFF;
 
+// pump bursts from the voltage sensor, PVSBREWTIME: shorter bursts are steam pulses (QuickMill)
+// PVSSTEAMGAP: steam-mode ends after this pause between pulses
+PulseTrain pumpPulses(PVSMERGETIME, PVSBREWTIME, PVSSTEAMGAP);
+
 // QuickMill thermoblock steam-mode (only for BREWDETECTION = 3)
-const int maxBrewDurationForSteamModeQM_ON =  200; // if brewtime is shorter steam-mode starts
-const int minPVSOffTimedForSteamModeQM_OFF = 1500; // if PVS-off-time is longer steam-mode ends
-unsigned long timePVStoON = 0;                     // time pinvoltagesensor switched to ON
-unsigned long lastTimePVSwasON = 0;                // last time pinvoltagesensor was ON
 bool steamQM_active = false;                       // steam-mode is active
-bool brewSteamDetectedQM = false;                  // brew/steam detected, not sure yet what it is
 bool coolingFlushDetectedQM = false;
 
 //Pressure sensor
@@ -184,9 +356,11 @@ bool coolingFlushDetectedQM = false;
 int offset = OFFSET;
 int fullScale = FULLSCALE;
 int maxPressure = MAXPRESSURE;
-float inputPressure = 0;
-const unsigned long intervalPressure = 200;
-unsigned long previousMillisPressure;  // initialisation at the end of init()
+float inputPressure = 0;   // bar, new every PRESSURESAMPLETIME * PRESSUREDECIMATION ms
+const unsigned long intervalPressure = PRESSURESAMPLETIME;   // ms between ADC readings
+AdcDecimator pressureDecimator(PRESSUREDECIMATION);
+unsigned long pressureReadings = 0;
+unsigned long pressureUpdates = 0;
 #endif
 
 
@@ -198,13 +372,14 @@ int relayON, relayOFF;          // used for relay trigger type. Do not change!
 boolean kaltstart = true;       // true = Rancilio started for first time
 boolean emergencyStop = false;  // Notstop bei zu hoher Temperatur
 double EmergencyStopTemp = 120; // Temp EmergencyStopTemp
-int inX = 0, inY = 0, inOld = 0, inSum = 0; //used for filter()
 int bars = 0; //used for getSignalStrength()
 boolean brewDetected = 0;
 boolean setupDone = false;
 int backflushON = 0;            // 1 = activate backflush
 int flushCycles = 0;            // number of active flush cycles
 int backflushState = 10;        // counter for state machine
+int autotuneON = 0;             // 1 = run autotune as soon as the machine is in state 20
+Autotune autotune;
 static const char *machineName[] PROGMEM =
 {
   "Rancilio Silvia",
@@ -214,17 +389,19 @@ static const char *machineName[] PROGMEM =
 };
 
 /********************************************************
-   moving average - brewdetection
+   Temperature readings, a DS18B20 conversion takes
+   94 ms (9 bit) to 750 ms (12 bit), then each sensor
+   needs one pass to be read
+*****************************************************/
+const unsigned long intervaltempmestsic = 400 ;
+const unsigned long intervaltempmesds18b20 = DS18B20RESOLUTION >= 12 ? (TEMPSENSORS > 2 ? 1000 : 800) : 400 ;
+const unsigned long intervaltempmes = TEMPSENSOR == 1 ? intervaltempmesds18b20 : intervaltempmestsic ;
+
+/********************************************************
+   heat rate - brewdetection
 *****************************************************/
-const int numReadings = 15;             // number of values per Array
-double readingstemp[numReadings];        // the readings from Temp
-unsigned long readingstime[numReadings];        // the readings from time
-double readingchangerate[numReadings];
-
-int readIndex = 1;              // the index of the current reading
-double total = 0;               // total sum of readingchangerate[]
-double heatrateaverage = 0;     // the average over the numReadings
-double changerate = 0;          // local change rate of temprature
+SlopeEstimator<BREWDETECTIONWINDOW> heatRate(intervaltempmes);  // one sample per reading
+double heatrateaverage = 0;     // slope of Input over the window, 1/1000 C per s
 double heatrateaveragemin = 0 ;
 unsigned long  timeBrewdetection = 0 ;
 int timerBrewdetection = 0 ;    // flag is set if brew was detected
@@ -256,23 +433,30 @@ const int PonE = PONE;
    Sensor check
 ******************************************************/
 boolean sensorError = false;
+boolean sensorStuck = false;    // same reading for SENSORSTUCKTIME with the heater on
+#if (TEMPOBSERVER == 1)
+TempObserver tempObserver(HEATERPOWER, BOILERCAPACITY, BOILERLOSS, SENSORTAU, 20);  // 20 C ambient
+#endif
 int error = 0;
-int maxErrorCounter = 10 ;  //depends on intervaltempmes* , define max seconds for invalid data
+int maxErrorCounter = 10 ;  //depends on intervaltempmes , define max seconds for invalid data
+// C, spikes are at least SENSORFILTERLIMIT times this off the median: noise plus one step of the sensor
+const float sensorFilterMinScale = 0.3 + (TEMPSENSOR == 1 ? 0.0625 * (1 << (12 - DS18B20RESOLUTION)) : 0);
+SensorFilter<SENSORFILTERWINDOW> sensorFilter(0, 150, SENSORFILTERLIMIT, sensorFilterMinScale,
+                                              SENSORSTUCKTIME * 1000UL / intervaltempmes);
+unsigned long sensorVerdicts[4] = {0, 0, 0, 0};  // readings per SensorFilter verdict
 
 /********************************************************
    PID
 ******************************************************/
-unsigned long previousMillistemp;  // initialisation at the end of init()
-const unsigned long intervaltempmestsic = 400 ;
-const unsigned long intervaltempmesds18b20 = 400  ;
 int pidMode = 1; //1 = Automatic, 0 = Manual
 
 const unsigned int windowSize = 1000;
 unsigned int isrCounter = 0;  // counter for ISR
 unsigned long windowStartTime;
 double Input, Output;
+double sensorInput = 0;  // last valid sensor reading, equals Input with TEMPOBSERVER 0
+double feedForward = 0;  // heater output added to the PID output at shot start (FEEDFORWARD)
 double setPointTemp;
-double previousInput = 0;
 
 double BrewSetPoint = SETPOINT;
 double setPoint = BrewSetPoint;
@@ -297,14 +481,19 @@ double aggKi = aggKp / aggTn;
 #endif
 double aggKd = aggTv * aggKp ;
 
+#if (PID_FIXEDPOINT == 1)
+PIDFixed bPID(&Input, &Output, &setPoint, aggKp, aggKi, aggKd, PonE, DIRECT);    //PID initialisation
+#else
 PID bPID(&Input, &Output, &setPoint, aggKp, aggKi, aggKd, PonE, DIRECT);    //PID initialisation
+#endif
 
 /********************************************************
    DALLAS TEMP
 ******************************************************/
 OneWire oneWire(ONE_WIRE_BUS);         // Setup a oneWire instance to communicate with any OneWire devices (not just Maxim/Dallas temperature ICs)
 DallasTemperature sensors(&oneWire);   // Pass our oneWire reference to Dallas Temperature.
-DeviceAddress sensorDeviceAddress;     // arrays to hold device address
+TempSensorBus tempSensors(sensors);    // up to TEMPSENSORS DS18B20, one conversion for all
+const float tempSensorWeights[TempSensorBus::maxSensors] = TEMPSENSORWEIGHTS;  // share in the PID input
 
 /********************************************************
    Temp Sensors TSIC 306
@@ -317,14 +506,62 @@ TSIC Sensor1(ONE_WIRE_BUS);   // only Signalpin, VCCpin unused by default
 #else 
 ZACwire<ONE_WIRE_BUS> Sensor2(306);    // set pin "2" to receive signal from the TSic "306"
 #endif
+uint8_t tsicFrames = 0;         // frames averaged into the last reading
+unsigned long tsicAgeUs = 0;    // age of the last reading, mean over its frames
 /********************************************************
    BLYNK
 ******************************************************/
 //Update Intervall zur App
-unsigned long previousMillisBlynk;  // initialisation at the end of init()
 const unsigned long intervalBlynk = 1000;
 int blynksendcounter = 1;
 
+// last sent values of sendToBlynk(): sent again when they moved by more
+// than the deadband (absolute, relative) or after the heartbeat
+#if (TELEMETRYDEADBAND == 1)
+const unsigned long telemetryHeartbeat = TELEMETRYHEARTBEAT * 1000UL;
+#else
+const unsigned long telemetryHeartbeat = 0;    // every value every cycle
+#endif
+Deadband sentInput(0.1, 0, telemetryHeartbeat);               // C
+Deadband sentSensorInput(0.1, 0, telemetryHeartbeat);
+Deadband sentSensors[TempSensorBus::maxSensors] = {
+  Deadband(0.1, 0, telemetryHeartbeat), Deadband(0.1, 0, telemetryHeartbeat),
+  Deadband(0.1, 0, telemetryHeartbeat), Deadband(0.1, 0, telemetryHeartbeat),
+};
+Deadband sentOutput(10, 0, telemetryHeartbeat);               // 1 % of windowSize
+Deadband sentFlow(0.1, 0, telemetryHeartbeat);                // g/s
+Deadband sentSetPoint(0, 0, telemetryHeartbeat);              // any change
+Deadband sentHeatrate(1, 0, telemetryHeartbeat);              // 1/1000 C per s
+Deadband sentHeatrateMin(1, 0, telemetryHeartbeat);
+Deadband sentGrafana[7] = {                                   // V60: Input, Output, Kp, Ki, Kd, setPoint, heat rate
+  Deadband(0.1, 0, telemetryHeartbeat), Deadband(10, 0, telemetryHeartbeat),
+  Deadband(0, 0.01, telemetryHeartbeat), Deadband(0, 0.01, telemetryHeartbeat),
+  Deadband(0, 0.01, telemetryHeartbeat), Deadband(0, 0, telemetryHeartbeat),
+  Deadband(1, 0, telemetryHeartbeat),
+};
+Deadband sentHeaterPower(10, 0, telemetryHeartbeat);
+Deadband sentKp(0, 0.01, telemetryHeartbeat);
+Deadband sentKi(0, 0.01, telemetryHeartbeat);
+Deadband sentPidON(0, 0, telemetryHeartbeat);
+Deadband sentBrewtime(0, 0, telemetryHeartbeat);
+Deadband sentPreinfusionpause(0, 0, telemetryHeartbeat);
+Deadband sentPreinfusion(0, 0, telemetryHeartbeat);
+Deadband sentSteamON(0, 0, telemetryHeartbeat);
+
+// after a reconnect everything goes out again: what was sent while the
+// link was down has been dropped, and the server may have lost its state
+void resetTelemetry()
+{
+  Deadband* all[] = {
+    &sentInput, &sentSensorInput, &sentOutput, &sentFlow, &sentSetPoint, &sentHeatrate,
+    &sentHeatrateMin, &sentHeaterPower, &sentKp, &sentKi, &sentPidON, &sentBrewtime,
+    &sentPreinfusionpause, &sentPreinfusion, &sentSteamON,
+  };
+  for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) all[i]->reset();
+  for (size_t i = 0; i < sizeof(sentSensors) / sizeof(sentSensors[0]); i++) sentSensors[i].reset();
+  for (size_t i = 0; i < sizeof(sentGrafana) / sizeof(sentGrafana[0]); i++) sentGrafana[i].reset();
+}
+
 
 /********************************************************
   Get Wifi signal strength and set bars for display
@@ -364,7 +601,6 @@ void getSignalStrength() {
     U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0);    //e.g. 0.96"
 #endif
 //Update für Display
-unsigned long previousMillisDisplay;  // initialisation at the end of init()
 const unsigned long intervalDisplay = 500;
 
 //Standard Display or vertikal?
@@ -399,6 +635,7 @@ const unsigned long intervalDisplay = 500;
 ******************************************************/
 BLYNK_CONNECTED() {
   if (Offlinemodus == 0) {
+    resetTelemetry();
     Blynk.syncAll();
     //rtc.begin();
   }
@@ -406,13 +643,16 @@ BLYNK_CONNECTED() {
 
 BLYNK_WRITE(V4) {
   aggKp = param.asDouble();
+  pidTuningsChanged = true;
 }
 
 BLYNK_WRITE(V5) {
   aggTn = param.asDouble();
+  pidTuningsChanged = true;
 }
 BLYNK_WRITE(V6) {
   aggTv =  param.asDouble();
+  pidTuningsChanged = true;
 }
 
 BLYNK_WRITE(V7) {
@@ -478,13 +718,16 @@ BLYNK_WRITE(V27)
 BLYNK_WRITE(V30)
 {
   aggbKp = param.asDouble();//
+  pidTuningsChanged = true;
 }
 
 BLYNK_WRITE(V31) {
   aggbTn = param.asDouble();
+  pidTuningsChanged = true;
 }
 BLYNK_WRITE(V32) {
   aggbTv =  param.asDouble();
+  pidTuningsChanged = true;
 }
 BLYNK_WRITE(V33) {
   brewtimersoftware =  param.asDouble();
@@ -495,15 +738,20 @@ BLYNK_WRITE(V34) {
 BLYNK_WRITE(V40) {
   backflushON =  param.asInt();
 }
+BLYNK_WRITE(V41) {
+  autotuneON =  param.asInt();
+}
 
 #if (COLDSTART_PID == 2)  // 2=?Blynk values, else default starttemp from config
   BLYNK_WRITE(V11) 
     {
     startKp = param.asDouble();
+    pidTuningsChanged = true;
     }
   BLYNK_WRITE(V14)
     {
       startTn = param.asDouble();
+      pidTuningsChanged = true;
     }
  #endif
 
@@ -511,23 +759,17 @@ BLYNK_WRITE(V40) {
 #if (PRESSURESENSOR == 1) // Pressure sensor connected
 
 /********************************************************
-  Pressure sensor
+  Pressure sensor, scheduler task every intervalPressure ms
   Verify before installation: meassured analog input value (should be 3,300 V for 3,3 V supply) and respective ADC value (3,30 V = 1023)
+  One ADC reading per call, every PRESSUREDECIMATION-th
+  call the decimator has a new low-pass mean (50 Hz with
+  the defaults) without the pump pulsation.
 *****************************************************/
 void checkPressure() {
-  float inputPressureFilter = 0;
-  unsigned long currentMillisPressure = millis();
-  if (currentMillisPressure - previousMillisPressure >= intervalPressure)
-  {
-    previousMillisPressure = currentMillisPressure;
-    
-    inputPressure = ((analogRead(PINPRESSURESENSOR) - offset) * maxPressure * 0.0689476) / (fullScale - offset);    // pressure conversion and unit conversion [psi] -> [bar]
-    inputPressureFilter = filter(inputPressure);
-    DEBUG_print("pressure raw: ");
-    DEBUG_println(inputPressure);
-    DEBUG_print("pressure filtered: ");
-    DEBUG_print(inputPressureFilter);
-  }  
+  pressureReadings++;
+  if (!pressureDecimator.add(analogRead(PINPRESSURESENSOR))) return;
+  pressureUpdates++;
+  inputPressure = ((pressureDecimator.value() - offset) * maxPressure * 0.0689476) / (fullScale - offset);    // pressure conversion and unit conversion [psi] -> [bar]
 }
 
 #endif
@@ -551,62 +793,56 @@ void testEmergencyStop() {
 }
 
 /********************************************************
-  Moving average - brewdetection (SW)
+  Heat rate - brewdetection (SW), least squares slope
+  of the last BREWDETECTIONWINDOW readings or, with
+  TEMPOBSERVER 1, the slope of the observer estimate
 *****************************************************/
 void movAvg() {
   if (firstreading == 1) {
-    for (int thisReading = 0; thisReading < numReadings; thisReading++) {
-      readingstemp[thisReading] = Input;
-      readingstime[thisReading] = 0;
-      readingchangerate[thisReading] = 0;
-    }
+    heatRate.reset(Input);
     firstreading = 0 ;
   }
 
-  readingstime[readIndex] = millis() ;
-  readingstemp[readIndex] = Input ;
-
-  if (readIndex == numReadings - 1) {
-    changerate = (readingstemp[numReadings - 1] - readingstemp[0]) / (readingstime[numReadings - 1] - readingstime[0]) * 10000;
-  } else {
-    changerate = (readingstemp[readIndex] - readingstemp[readIndex + 1]) / (readingstime[readIndex] - readingstime[readIndex + 1]) * 10000;
-  }
-
-  readingchangerate[readIndex] = changerate ;
-  total = 0 ;
-  for (int i = 0; i < numReadings; i++)
-  {
-    total += readingchangerate[i];
-  }
-
-  heatrateaverage = total / numReadings * 100 ;
+  #if (TEMPOBSERVER == 1)
+    heatrateaverage = tempObserver.rate() * 1000 ;
+  #else
+    heatRate.add(Input, millis());   // fills in readings refreshTemp() skipped
+    heatrateaverage = heatRate.slope() * 1000 ;
+  #endif
   if (heatrateaveragemin > heatrateaverage) {
     heatrateaveragemin = heatrateaverage ;
   }
-
-  if (readIndex >= numReadings - 1) {
-    // ...wrap around to the beginning:
-    readIndex = 0;
-  } else {
-    readIndex++;
-  }
 }
 
 
 /********************************************************
   check sensor value.
-  If < 0 or difference between old and new >25, then increase error.
+  If sensorFilter finds it out of range (0..150 C) or a
+  spike against the median of the last readings, then
+  increase error.
   If error is equal to maxErrorCounter, then set sensorError
+  A value stuck while the heater runs hard (sensor or
+  heater fault) only sets sensorStuck and is logged, it
+  does not latch kSensorError.
 *****************************************************/
 boolean checkSensor(float tempInput) {
   boolean sensorOK = false;
-  boolean badCondition = ( tempInput < 0 || tempInput > 150 || fabs(tempInput - previousInput) > 5);
+  // stuck only counts while the heater runs at least half the window, the
+  // reading must move then; at a steady temperature it may repeat forever
+  SensorFilter<SENSORFILTERWINDOW>::Verdict verdict = sensorFilter.check(tempInput, Output >= windowSize / 2);
+  sensorVerdicts[verdict]++;
+  boolean stuck = verdict == SensorFilter<SENSORFILTERWINDOW>::kStuck;
+  if (stuck && !sensorStuck) {
+    debugStream.writeE("*** ERROR: temperature sensor stuck at %.2f C for %i s with the heater on", tempInput, SENSORSTUCKTIME);
+  }
+  sensorStuck = stuck;
+  boolean badCondition = verdict != SensorFilter<SENSORFILTERWINDOW>::kValid && !stuck;
   if ( badCondition && !sensorError) {
     error++;
     sensorOK = false;
     if (error >= 5) // warning after 5 times error
     {
-     debugStream.writeW("*** WARNING: temperature sensor reading: consec_errors = %i, temp_current = %.1f",error,tempInput);
+     debugStream.writeW("*** WARNING: temperature sensor reading: consec_errors = %i, temp_current = %.1f, %s",error,tempInput,SensorFilter<SENSORFILTERWINDOW>::verdictName(verdict));
     }
   } else if (badCondition == false && sensorOK == false) {
     error = 0;
@@ -614,7 +850,7 @@ boolean checkSensor(float tempInput) {
   }
   if (error >= maxErrorCounter && !sensorError) {
     sensorError = true ;
-    debugStream.writeE("*** ERROR: temperature sensor malfunction: temp_current = %.1f",tempInput);
+    debugStream.writeE("*** ERROR: temperature sensor malfunction: temp_current = %.1f, %s",tempInput,SensorFilter<SENSORFILTERWINDOW>::verdictName(verdict));
   } else if (error == 0 && sensorError) {
     sensorError = false ;
   }
@@ -622,53 +858,131 @@ boolean checkSensor(float tempInput) {
 }
 
 /********************************************************
-  Refresh temperature.
+  DS18B20: scheduler task on every pass, reads one sensor
+  per pass once the conversion is through
+*****************************************************/
+void pollTempSensors() {
+  tempSensors.poll();
+}
+
+/********************************************************
+  TSic on GPIO16 (no pin interrupt for ZACwire): scheduler
+  task on every pass, TSIC::pollTemperature() only reads
+  when the next frame is due. readTsicFrames() returns
+  the mean of the frames since the last reading, -50 C
+  (rejected by checkSensor()) if there was none.
+*****************************************************/
+#if (ONE_WIRE_BUS == 16 && TEMPSENSOR == 2 && defined(ESP8266))
+float tsicSum = 0;
+uint8_t tsicCount = 0;
+unsigned long tsicMeanUs = 0;   // mean capture time of the frames
+
+void pollTsic() {
+  uint16_t raw;
+  if (!Sensor1.pollTemperature(&raw)) return;
+  tsicCount++;
+  tsicSum += Sensor1.calc_Celsius(&raw);
+  tsicMeanUs += (long)(micros() - tsicMeanUs) / tsicCount;
+}
+
+float readTsicFrames() {
+  tsicFrames = tsicCount;
+  if (tsicCount == 0) {
+    temperature = 0;
+    return Sensor1.calc_Celsius(&temperature);
+  }
+  float mean = tsicSum / tsicCount;
+  tsicAgeUs = micros() - tsicMeanUs;
+  tsicSum = 0;
+  tsicCount = 0;
+  return mean;
+}
+#endif
+
+/********************************************************
+  TSic via ZACwire: mean of all frames (10 per second)
+  captured since the last reading. Without a new frame
+  getTemp() reports the wire state (221 = no sensor).
+*****************************************************/
+#if ((ONE_WIRE_BUS != 16 && defined(ESP8266)) || defined(ESP32))
+float readTsicFrames() {
+  float celsius, sum = 0;
+  unsigned long capturedUs, ageUs = 0, now = micros();
+  uint8_t n = 0;
+  while (Sensor2.getSample(celsius, capturedUs)) {
+    sum += celsius;
+    ageUs += now - capturedUs;
+    n++;
+  }
+  tsicFrames = n;
+  if (n == 0) return Sensor2.getTemp();
+  tsicAgeUs = ageUs / n;
+  return sum / n;
+}
+#endif
+
+/********************************************************
+  Store a valid sensor reading. With TEMPOBSERVER 1 the
+  PID gets the observer estimate of the boiler
+  temperature, the reading itself stays in sensorInput.
+*****************************************************/
+void storeReading(float reading) {
+  sensorInput = reading;
+  #if (TEMPOBSERVER == 1)
+    double duty = (Output + feedForward) / windowSize;  // heater duty since the last PID window
+    tempObserver.update(reading, constrain(duty, 0, 1));
+    Input = tempObserver.temperature();
+  #else
+    Input = reading;
+  #endif
+}
+
+/********************************************************
+  Refresh temperature, scheduler task every
+  intervaltempmes ms.
   Each time checkSensor() is called to verify the value.
   If the value is not valid, new data is not stored.
 *****************************************************/
 void refreshTemp() {
-  unsigned long currentMillistemp = millis();
-  previousInput = Input ;
+  PROFILE_SCOPE(profileTemp);
   if (TempSensor == 1)
   {
-    if (currentMillistemp - previousMillistemp >= intervaltempmesds18b20)
-    {
-      previousMillistemp = currentMillistemp;
-      sensors.requestTemperatures();
-      if (!checkSensor(sensors.getTempCByIndex(0)) && firstreading == 0 ) return;  //if sensor data is not valid, abort function; Sensor must be read at least one time at system startup
-      Input = sensors.getTempCByIndex(0);
-      if (Brewdetection != 0) {
-        movAvg();
-      } else if (firstreading != 0) {
-        firstreading = 0;
-      }
+    // take the set of the conversion started one interval ago and start the
+    // next one for all sensors; a weighted sensor without a valid reading
+    // makes the reading invalid
+    if (!tempSensors.ready()) {
+      // no sensor found or no set for a few intervals: count it as a
+      // failed reading, so that the error counter and kSensorError trip
+      if (tempSensors.count() == 0 || millis() - tempSensors.setMs() > 3 * intervaltempmes) {
+        checkSensor(DEVICE_DISCONNECTED_C);
+        tempSensors.convert();  // restart a conversion that never completed
+      }
+      return;
+    }
+    float reading = DEVICE_DISCONNECTED_C;
+    tempSensors.mix(tempSensorWeights, reading);
+    tempSensors.convert();
+    if (!checkSensor(reading) && firstreading == 0 ) return;  //if sensor data is not valid, abort function; Sensor must be read at least one time at system startup
+    storeReading(reading);
+    if (Brewdetection != 0) {
+      movAvg();
+    } else if (firstreading != 0) {
+      firstreading = 0;
     }
   }
   if (TempSensor == 2)
   {
-    if (currentMillistemp - previousMillistemp >= intervaltempmestsic)
-    {
-      previousMillistemp = currentMillistemp;
-      /*  variable "temperature" must be set to zero, before reading new data
-            getTemperature only updates if data is valid, otherwise "temperature" will still hold old values
-      */
-      temperature = 0;
-       #if (ONE_WIRE_BUS == 16 && defined(ESP8266))
-         Sensor1.getTemperature(&temperature);
-         Temperatur_C = Sensor1.calc_Celsius(&temperature);
-         #endif
-       #if ((ONE_WIRE_BUS != 16 && defined(ESP8266)) || defined(ESP32))
-        Temperatur_C = Sensor2.getTemp();
-        //DEBUG_println(Temperatur_C);
-       #endif
-      //Temperatur_C = 70;
-      if (!checkSensor(Temperatur_C) && firstreading == 0) return;  //if sensor data is not valid, abort function; Sensor must be read at least one time at system startup
-      Input = Temperatur_C;
-      if (Brewdetection != 0) {
-        movAvg();
-      } else if (firstreading != 0) {
-        firstreading = 0;
-      }
+     // mean of the frames since the last reading, GPIO16 or ZACwire
+     #if ((ONE_WIRE_BUS == 16 && TEMPSENSOR == 2 && defined(ESP8266)) || (ONE_WIRE_BUS != 16 && defined(ESP8266)) || defined(ESP32))
+      Temperatur_C = readTsicFrames();
+     #endif
+    //Temperatur_C = 70;
+    if (!checkSensor(Temperatur_C) && firstreading == 0) return;  //if sensor data is not valid, abort function; Sensor must be read at least one time at system startup
+    storeReading(Temperatur_C);
+    if (Brewdetection != 0) {
+      movAvg();
+    } else if (firstreading != 0) {
+      firstreading = 0;
     }
   }
 }
@@ -703,80 +1017,66 @@ void initOfflineMode()
 }
 
 /*******************************************************
-   Check if Wifi is connected, if not reconnect
-   abort function if offline, or brew is running
+   Network links of the ConnectionManager: start() only
+   kicks off an attempt, connected() reports the state.
+   Blynk and MQTT start with a ServerProbe; only once
+   the server has answered does connected() call the
+   library's connect(), with the probed address, so it
+   blocks for one round trip and not for the lookup and
+   the connect timeout of an unreachable server.
 *****************************************************/
-void checkWifi() {
-  if (Offlinemodus == 1 || brewcounter > 11) return;
-  do {
-    if ((millis() - lastWifiConnectionAttempt >= wifiConnectionDelay) && (wifiReconnects <= maxWifiReconnects)) {
-      int statusTemp = WiFi.status();
-      if (statusTemp != WL_CONNECTED) {   // check WiFi connection status
-        lastWifiConnectionAttempt = millis();
-        wifiReconnects++;
-        debugStream.writeI("Attempting WIFI reconnection: %i",wifiReconnects);
-        if (!setupDone) {
-           #if DISPLAY != 0
-            displayMessage("", "", "", "", langstring_wifirecon, String(wifiReconnects));
-          #endif
-        }
-        WiFi.disconnect();
-        WiFi.begin(ssid, pass);   // attempt to connect to Wifi network
-        int count = 1;
-        while (WiFi.status() != WL_CONNECTED && count <= 20) {
-          delay(100);   //give WIFI some time to connect
-          count++;      //reconnect counter, maximum waiting time for reconnect = 20*100ms
-        }
-      }
-    }
-    yield();  //Prevent WDT trigger
-  } while ( !setupDone && wifiReconnects < maxWifiReconnects && WiFi.status() != WL_CONNECTED);   //if kaltstart ist still true when checkWifi() is called, then there was no WIFI connection at boot -> connect or offlinemode
+void wifiStart()
+{
+  debugStream.writeI("Attempting WIFI connection: %lu", (unsigned long)connection.link(kLinkWifi).attempts);
+  WiFi.disconnect();
+  WiFi.begin(ssid, pass);   // associates in the background
+}
 
-  if (wifiReconnects >= maxWifiReconnects && !setupDone) {   // no wifi connection after boot, initiate offline mode (only directly after boot)
-    initOfflineMode();
-  }
+bool wifiConnected()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
 
+void blynkStart()
+{
+  debugStream.writeI("Attempting blynk connection: %lu", (unsigned long)connection.link(kLinkBlynk).attempts);
+  blynkLogin = false;
+  blynkProbe.start(blynkaddress, blynkport);
 }
 
-/*******************************************************
-   Check if Blynk is connected, if not reconnect
-   abort function if offline, or brew is running
-   blynk is also using maxWifiReconnects!
-*****************************************************/
-void checkBlynk() {
-  if (Offlinemodus == 1 || brewcounter > 11) return;
-  if ((millis() - lastBlynkConnectionAttempt >= wifiConnectionDelay) && (blynkReCnctCount <= maxWifiReconnects)) {
-    int statusTemp = Blynk.connected();
-    if (statusTemp != 1) {   // check Blynk connection status
-      lastBlynkConnectionAttempt = millis();        // Reconnection Timer Function
-      blynkReCnctCount++;  // Increment reconnection Counter
-      debugStream.writeI("Attempting blynk reconnection: %i",blynkReCnctCount);
-      Blynk.connect(3000);  // Try to reconnect to the server; connect() is a blocking function, watch the timeout!
-    }
+bool blynkConnected()
+{
+  if (blynkProbe.poll() == ServerProbe::kReachable)
+  {
+    blynkProbe.done();
+    Blynk.config(auth, IPAddress(blynkProbe.address()), blynkport);
+    Blynk.connect(blynkConnectSlice);   // Blynk.run() in networkTask() finishes the login
+    blynkLogin = true;
   }
+  return Blynk.connected();
 }
 
+void mqttStart()
+{
+  debugStream.writeI("Attempting MQTT connection: %lu", (unsigned long)connection.link(kLinkMqtt).attempts);
+  mqttProbe.start(mqtt_server_ip, mqtt_server_port);
+}
 
-
-/*******************************************************
-   Check if MQTT is connected, if not reconnect
-   abort function if offline, or brew is running
-   MQTT is also using maxWifiReconnects!
-*****************************************************/
-void checkMQTT(){
-  if (Offlinemodus == 1 || brewcounter > 11) return;
-  if ((millis() - lastMQTTConnectionAttempt >= wifiConnectionDelay) && (MQTTReCnctCount <= maxWifiReconnects)) {
-    int statusTemp = mqtt.connected();
-    if (statusTemp != 1) {   // check Blynk connection status
-      lastMQTTConnectionAttempt = millis();        // Reconnection Timer Function
-      MQTTReCnctCount++;  // Increment reconnection Counter
-      debugStream.writeI("Attempting MQTT reconnection: %i",MQTTReCnctCount);
-      if (mqtt.connect(hostname, mqtt_username, mqtt_password,topic_will,0,0,"exit") == true);{
-        mqtt.subscribe(topic_set);
-        debugStream.writeI("Subscribe to MQTT Topics");
-      }  // Try to reconnect to the server; connect() is a blocking function, watch the timeout!
+bool mqttConnected()
+{
+  if (mqttProbe.poll() == ServerProbe::kReachable)
+  {
+    mqttProbe.done();
+    mqtt.setServer(IPAddress(mqttProbe.address()), mqtt_server_port);
+    // handshake and CONNACK, one round trip each, at most mqttSocketTimeout for the CONNACK
+    if (mqtt.connect(hostname, mqtt_username, mqtt_password, topic_will, 0, 0, "exit"))
+    {
+      mqtt.subscribe(topic_set);
+      debugStream.writeI("Subscribe to MQTT Topics");
+      resetTelemetry();
     }
   }
+  return mqtt.connected();
 }
 
 /*******************************************************
@@ -810,70 +1110,159 @@ char* number2string(unsigned int in) {
 bool mqtt_publish(const char *reading, char *payload)
 {
 #if MQTT
-    char topic[120];
-    snprintf(topic, 120, "%s%s/%s", mqtt_topic_prefix, hostname, reading);
-    return mqtt.publish(topic, payload, true);
+    strncpy(mqtt_topic + mqtt_topic_len, reading, sizeof(mqtt_topic) - mqtt_topic_len - 1);
+    return mqtt.publish(mqtt_topic, payload, true);
 #else
     return false;
 #endif
 }
 
+/*******************************************************
+   Telemetry of sendToBlynk(): one topic per reading, or
+   with MQTT_BATCH 1 collected into one JSON document
+   that mqtt_telemetry_flush() publishes to .../telemetry
+*****************************************************/
+void mqtt_telemetry(const char *reading, char *payload)
+{
+#if MQTT_BATCH == 1
+    char first = payload[0] == '-' ? payload[1] : payload[0];
+    const char *value = isdigit(first) ? payload : "null";  // nan, inf
+    size_t room = sizeof(mqtt_batch) - 1 - mqtt_batch_len;  // 1 for the closing brace
+    int len = snprintf(mqtt_batch + mqtt_batch_len, room, "%c\"%s\":%s", mqtt_batch_len ? ',' : '{', reading, value);
+    if (len > 0 && (size_t)len < room) {
+      mqtt_batch_len += len;
+    } else {
+      mqtt_batch[mqtt_batch_len] = '\0';
+      mqtt_batch_dropped++;
+    }
+#else
+    mqtt_publish(reading, payload);
+#endif
+}
+
+void mqtt_telemetry_flush()
+{
+#if MQTT_BATCH == 1
+    if (mqtt_batch_len == 0) return;
+    mqtt_batch[mqtt_batch_len++] = '}';
+    mqtt_batch[mqtt_batch_len] = '\0';
+    mqtt_publish("telemetry", mqtt_batch);
+    mqtt_batch_len = 0;
+    if (mqtt_batch_dropped > 0) {
+      debugStream.writeE("MQTT: %u readings did not fit the telemetry message", mqtt_batch_dropped);
+      mqtt_batch_dropped = 0;
+    }
+#endif
+}
+
 /********************************************************
-  send data to Blynk server
+  send data to Blynk server, scheduler task every
+  intervalBlynk ms
 *****************************************************/
 
 void sendToBlynk() {
+  PROFILE_SCOPE(profileBlynkSend);
   if (Offlinemodus == 1) return;
 
-  unsigned long currentMillisBlynk = millis();
-
-  if (currentMillisBlynk - previousMillisBlynk >= intervalBlynk) {
-
-    //MQTT
-    if (MQTT == 1) {
-      checkMQTT();
-    }
-
-    previousMillisBlynk = currentMillisBlynk;
-    if (Blynk.connected()) {
-      if (blynksendcounter == 1) {
+  if (Blynk.connected()) {
+    unsigned long now = millis();
+    if (blynksendcounter == 1) {
+      if (sentInput.update(Input, now)) {
         Blynk.virtualWrite(V2, Input);
-        mqtt_publish("temperature", number2string(Input));
+        mqtt_telemetry("temperature", number2string(Input));
       }
-      if (blynksendcounter == 2) {
-        Blynk.virtualWrite(V23, Output);
+      #if (TEMPOBSERVER == 1)
+        if (sentSensorInput.update(sensorInput, now)) mqtt_telemetry("sensorTemperature", number2string(sensorInput));
+      #endif
+      if (TempSensor == 1 && tempSensors.count() > 1) {
+        char name[24];
+        for (int i = 0; i < tempSensors.count(); i++) {
+          if (!tempSensors.sensor(i).valid) continue;
+          if (!sentSensors[i].update(tempSensors.sensor(i).celsius, now)) continue;
+          snprintf(name, sizeof(name), "sensorTemperature%u", i);
+          mqtt_telemetry(name, number2string(tempSensors.sensor(i).celsius));
+        }
+      }
+    }
+    if (blynksendcounter == 2) {
+      if (sentOutput.update(Output, now)) Blynk.virtualWrite(V23, Output);
+    }
+    #if (BREWMODE == 2 || ONLYPIDSCALE == 1)
+      // while something flows and it changed, once more when it stopped
+      static float flowPublished = 0;
+      float flow = fabs(flowRate) < 0.1 ? 0 : flowRate;  // scale noise
+      if ((flow != 0 || flowPublished != 0) && sentFlow.update(flow, now)) {
+        Blynk.virtualWrite(V37, flow);
+        mqtt_telemetry("flowRate", number2string(flow));
+        flowPublished = flow;
       }
-      if (blynksendcounter == 3) {
+    #endif
+    if (blynksendcounter == 3) {
+      if (sentSetPoint.update(setPoint, now)) {
         Blynk.virtualWrite(V17, setPoint);
         //MQTT
-        mqtt_publish("setPoint", number2string(setPoint));
-      }
-      if (blynksendcounter == 4) {
-        Blynk.virtualWrite(V35, heatrateaverage);
-      }
-      if (blynksendcounter == 5) {
-        Blynk.virtualWrite(V36, heatrateaveragemin);
+        mqtt_telemetry("setPoint", number2string(setPoint));
       }
-      if (grafana == 1 && blynksendcounter >= 6) {
-        // Blynk.virtualWrite(V60, Input, Output, bPID.GetKp(), bPID.GetKi(), bPID.GetKd(), setPoint );
-        Blynk.virtualWrite(V60, Input, Output, bPID.GetKp(), bPID.GetKi(), bPID.GetKd(), setPoint, heatrateaverage);
-         if (MQTT == 1)
-         {
-            mqtt_publish("HeaterPower", number2string(Output));
-            mqtt_publish("Kp", number2string(bPID.GetKp()));
-            mqtt_publish("Ki", number2string(bPID.GetKi()));
-            mqtt_publish("pidON", number2string(pidON));
-            mqtt_publish("brewtime", number2string(brewtime/1000));
-            mqtt_publish("preinfusionpause", number2string(preinfusionpause/1000));
-            mqtt_publish("preinfusion", number2string(preinfusion/1000));
-            mqtt_publish("SteamON", number2string(SteamON));
-         }
-        blynksendcounter = 0;
-      } else if (grafana == 0 && blynksendcounter >= 5) {
-        blynksendcounter = 0;
-      }
-      blynksendcounter++;
     }
+    if (blynksendcounter == 4) {
+      if (sentHeatrate.update(heatrateaverage, now)) Blynk.virtualWrite(V35, heatrateaverage);
+    }
+    if (blynksendcounter == 5) {
+      if (sentHeatrateMin.update(heatrateaveragemin, now)) Blynk.virtualWrite(V36, heatrateaveragemin);
+    }
+    if (grafana == 1 && blynksendcounter >= 6) {
+      // the whole row when one of its values changed
+      bool changed = false;
+      changed |= sentGrafana[0].update(Input, now);
+      changed |= sentGrafana[1].update(Output, now);
+      changed |= sentGrafana[2].update(bPID.GetKp(), now);
+      changed |= sentGrafana[3].update(bPID.GetKi(), now);
+      changed |= sentGrafana[4].update(bPID.GetKd(), now);
+      changed |= sentGrafana[5].update(setPoint, now);
+      changed |= sentGrafana[6].update(heatrateaverage, now);
+      // Blynk.virtualWrite(V60, Input, Output, bPID.GetKp(), bPID.GetKi(), bPID.GetKd(), setPoint );
+      if (changed) Blynk.virtualWrite(V60, Input, Output, bPID.GetKp(), bPID.GetKi(), bPID.GetKd(), setPoint, heatrateaverage);
+       if (MQTT == 1)
+       {
+          if (sentHeaterPower.update(Output, now)) mqtt_telemetry("HeaterPower", number2string(Output));
+          if (sentKp.update(bPID.GetKp(), now)) mqtt_telemetry("Kp", number2string(bPID.GetKp()));
+          if (sentKi.update(bPID.GetKi(), now)) mqtt_telemetry("Ki", number2string(bPID.GetKi()));
+          if (sentPidON.update(pidON, now)) mqtt_telemetry("pidON", number2string(pidON));
+          if (sentBrewtime.update(brewtime, now)) mqtt_telemetry("brewtime", number2string(brewtime/1000));
+          if (sentPreinfusionpause.update(preinfusionpause, now)) mqtt_telemetry("preinfusionpause", number2string(preinfusionpause/1000));
+          if (sentPreinfusion.update(preinfusion, now)) mqtt_telemetry("preinfusion", number2string(preinfusion/1000));
+          if (sentSteamON.update(SteamON, now)) mqtt_telemetry("SteamON", number2string(SteamON));
+       }
+      blynksendcounter = 0;
+    } else if (grafana == 0 && blynksendcounter >= 5) {
+      blynksendcounter = 0;
+    }
+    blynksendcounter++;
+    mqtt_telemetry_flush();
+  }
+}
+
+/********************************************************
+  Voltage sensor (BREWDETECTION 3): every edge goes with
+  its time into pumpPulses, pollVoltageSensor() (task on
+  every pass) turns them into pump bursts
+******************************************************/
+void ICACHE_RAM_ATTR voltageSensorISR() {
+  pumpPulses.edge(digitalRead(PINVOLTAGESENSOR) == VoltageSensorON, micros());
+}
+
+void pollVoltageSensor() {
+  #if (PINVOLTAGESENSOR == 16 && defined(ESP8266))
+    // GPIO16 has no pin interrupt, edges at loop precision
+    static bool lastLevel = false;
+    bool level = digitalRead(PINVOLTAGESENSOR) == VoltageSensorON;
+    if (level != lastLevel) pumpPulses.edge(level, micros());
+    lastLevel = level;
+  #endif
+  PulseTrain::Kind kind = pumpPulses.kind();
+  pumpPulses.update(micros());
+  if (pumpPulses.kind() != kind) {
+    debugStream.writeV("PVS: %s, burst %lu ms, pulses %.2f Hz duty %.2f",PulseTrain::kindName(pumpPulses.kind()),pumpPulses.burstMs(),pumpPulses.pulseHz(),pumpPulses.duty());
   }
 }
 
@@ -910,17 +1299,16 @@ void brewdetection()
   } else if (Brewdetection == 3) 
   {
     // Bezugszeit hochzaehlen    
-    if (( digitalRead(PINVOLTAGESENSOR) == VoltageSensorON) && brewDetected == 1)
+    if (pumpPulses.active() && brewDetected == 1)
        {
        bezugsZeit = millis() - startZeit ;
        lastbezugszeit = bezugsZeit ;
        }
     //  OFF: Bezug zurücksetzen
     if 
-     ((digitalRead(PINVOLTAGESENSOR) == VoltageSensorOFF) && (brewDetected == 1 || coolingFlushDetectedQM == true) )
+     (!pumpPulses.active() && (brewDetected == 1 || coolingFlushDetectedQM == true) )
       {
         brewDetected = 0;
-        timePVStoON = bezugsZeit; // for QuickMill
         bezugsZeit = 0 ; 
         startZeit = 0;
         coolingFlushDetectedQM = false;
@@ -958,47 +1346,27 @@ void brewdetection()
 
       case QuickMill:
 
-      if (!coolingFlushDetectedQM) 
+      if (!coolingFlushDetectedQM && brewDetected == 0 && !steamQM_active) 
       {
-        int pvs = digitalRead(PINVOLTAGESENSOR);
-        if (pvs == VoltageSensorON && brewDetected == 0 && brewSteamDetectedQM == 0 && !steamQM_active) 
+        // pulses: steam, continuous pump: brew or cooling flush (hot boiler)
+        if (pumpPulses.kind() == PulseTrain::kPulsed)
+        {
+          debugStream.writeI("Quick Mill: steam-mode detected, pump pulse %lu ms",pumpPulses.burstMs());
+          initSteamQM();
+        }
+        else if (pumpPulses.kind() == PulseTrain::kContinuous)
         {
-          timeBrewdetection = millis();
-          timePVStoON = millis();
+          timeBrewdetection = pumpPulses.burstStartMs();
           timerBrewdetection = 1;
-          brewDetected = 0;
           lastbezugszeit = 0;
-          brewSteamDetectedQM = 1;
-          debugStream.writeI("Quick Mill: setting brewSteamDetectedQM = 1");
           logbrew.reset();
-        }
-
-        if (brewSteamDetectedQM == 1) 
-        {
-          if (pvs == VoltageSensorOFF)
-          {
-            brewSteamDetectedQM = 0;
-
-            if (millis() - timePVStoON < maxBrewDurationForSteamModeQM_ON)
-            {
-              debugStream.writeI("Quick Mill: steam-mode detected");
-              initSteamQM();
-            } else {
-              debugStream.writeE("*** ERROR: QuickMill: neither brew nor steam");
-            }
-          } 
-          else if (millis() - timePVStoON > maxBrewDurationForSteamModeQM_ON)
-          {
-            if( Input < BrewSetPoint + 2) {
-              debugStream.writeI("Quick Mill: brew-mode detected");
-              startZeit = timePVStoON; 
-              brewDetected = 1;
-              brewSteamDetectedQM = 0;
-            } else {
-              debugStream.writeI("Quick Mill: cooling-flush detected");
-              coolingFlushDetectedQM = true;
-              brewSteamDetectedQM = 0;
-            }
+          if( Input < BrewSetPoint + 2) {
+            debugStream.writeI("Quick Mill: brew-mode detected");
+            startZeit = pumpPulses.burstStartMs(); 
+            brewDetected = 1;
+          } else {
+            debugStream.writeI("Quick Mill: cooling-flush detected");
+            coolingFlushDetectedQM = true;
           }
         }
       }
@@ -1006,11 +1374,11 @@ void brewdetection()
       // no Quickmill: 
       default:
       previousMillisVoltagesensorreading = millis();
-      if (digitalRead(PINVOLTAGESENSOR) == VoltageSensorON && brewDetected == 0 ) 
+      if (pumpPulses.active() && brewDetected == 0 ) 
       {
         debugStream.writeI("HW Brew - Voltage Sensor -  Start") ;
-        timeBrewdetection = millis() ;
-        startZeit = millis() ;
+        timeBrewdetection = pumpPulses.burstStartMs() ;
+        startZeit = pumpPulses.burstStartMs() ;
         timerBrewdetection = 1 ;
         brewDetected = 1;
         lastbezugszeit = 0 ;
@@ -1020,22 +1388,7 @@ void brewdetection()
 }
 
 /********************************************************
-  after ~28 cycles the input is set to 99,66% if the real input value
-  sum of inX and inY multiplier must be 1
-  increase inX multiplier to make the filter faster
-*****************************************************/
-int filter(int input) {
-  inX = input * 0.3;
-  inY = inOld * 0.7;
-  inSum = inX + inY;
-  inOld = inSum;
-
-  return inSum;
-}
-
-
-/********************************************************
-    Timer 1 - ISR for PID calculation and heat realay output
+    Timer 1 - ISR for heat realay output, PID control task
 ******************************************************/
 
  #include "ISR.h"  
@@ -1154,7 +1507,6 @@ void checkSteamON()
       { // if true: steam-mode can be turned off
         SteamON = 0;
         steamQM_active = false;
-        lastTimePVSwasON = 0;
       } 
       else
       {
@@ -1192,9 +1544,7 @@ void initSteamQM()
   /*
     Initialize monitoring for steam switch off for QuickMill thermoblock
   */
-  lastTimePVSwasON = millis(); // time when pinvoltagesensor changes from ON to OFF
   steamQM_active = true;
-  timePVStoON = 0;
   SteamON = 1;
 }
 
@@ -1202,464 +1552,193 @@ boolean checkSteamOffQM()
 {
   /* 
     Monitor pinvoltagesensor during active steam mode of QuickMill thermoblock.
-    Once the pinvolagesenor remains OFF for longer than a pump-pulse time peride 
-    the switch is turned off and steam mode finished.
+    Once the pump has not pulsed for PVSSTEAMGAP ms the switch is turned off
+    and steam mode finished.
   */
-  if( digitalRead(PINVOLTAGESENSOR) == VoltageSensorON ) {
-    lastTimePVSwasON = millis();
+  return pumpPulses.kind() == PulseTrain::kIdle;
+}
+
+/********************************************************
+  Autotune: use the gain sets of a finished relay experiment,
+  store them and show them in the Blynk app
+******************************************************/
+void autotuneApply()
+{
+  PidGains normal = autotune.normalGains();
+  PidGains cold = autotune.coldStartGains();
+  PidGains brew = autotune.brewGains();
+
+  debugStream.writeI("autotune: Ku=%.1f Tu=%.1f s amplitude=%.2f C after %i cycles",
+    autotune.ultimateGain(), autotune.ultimatePeriod(), autotune.amplitude(), autotune.cycles());
+
+  aggKp = normal.kp;
+  aggTn = normal.tn;
+  aggTv = normal.tv;
+  startKp = cold.kp;
+  startTn = cold.tn;
+  aggbKp = brew.kp;
+  aggbTn = brew.tn;
+  aggbTv = brew.tv;
+  pidTuningsChanged = true;
+
+  debugStream.writeI("autotune: P=%.1f Tn=%.1f Tv=%.1f, start P=%.1f Tn=%.1f, BD P=%.1f Tn=%.1f Tv=%.1f",
+    aggKp, aggTn, aggTv, startKp, startTn, aggbKp, aggbTn, aggbTv);
+
+  if (Blynk.connected())
+  {
+    Blynk.virtualWrite(V4, aggKp);
+    Blynk.virtualWrite(V5, aggTn);
+    Blynk.virtualWrite(V6, aggTv);
+    Blynk.virtualWrite(V11, startKp);
+    Blynk.virtualWrite(V14, startTn);
+    Blynk.virtualWrite(V30, aggbKp);
+    Blynk.virtualWrite(V31, aggbTn);
+    Blynk.virtualWrite(V32, aggbTv);
   }
+  writeSysParamsToStorage();
+}
 
-  if( (millis() - lastTimePVSwasON) > minPVSOffTimedForSteamModeQM_OFF ) {
-    lastTimePVSwasON = 0;
-    return true;
+#include "machinestate.h"
+
+// scheduler task every 10 s
+void debugVerboseOutput()
+{
+  debugStream.writeV("Tsoll=%5.1f  Tist=%5.1f Machinestate=%2i KP=%4.2f KI=%4.2f KD=%4.2f",BrewSetPoint,Input,machinestate,bPID.GetKp(),bPID.GetKi(),bPID.GetKd());
+  debugStream.writeV("ISR: calls=%lu last=%lu max=%lu cycles @ %u MHz",(unsigned long)isrTiming.calls,(unsigned long)isrTiming.lastCycles,(unsigned long)isrTiming.maxCycles,(unsigned int)ESP.getCpuFreqMHz());
+  #if (ONE_WIRE_BUS == 16 && TEMPSENSOR == 2 && defined(ESP8266))
+    debugStream.writeV("TSIC: frames=%u age=%lu ms period=%lu us",tsicFrames,tsicAgeUs / 1000,(unsigned long)Sensor1.framePeriod());
+  #elif ((ONE_WIRE_BUS != 16 && defined(ESP8266)) || defined(ESP32))
+    if (TempSensor == 2) debugStream.writeV("TSIC: frames=%u age=%lu ms lost=%u",tsicFrames,tsicAgeUs / 1000,Sensor2.samplesLost());
+  #endif
+  if (TOF != 0) {
+    debugStream.writeV("TOF: distance=%.0f mm water=%.0f %% ranges=%lu invalid=%lu",distance,percentage,tofRanges,tofInvalid);
+  }
+  #if (PRESSURESENSOR == 1)
+    debugStream.writeV("PRESSURE: %.2f bar readings=%lu updates=%lu in 10 s",inputPressure,pressureReadings,pressureUpdates);
+    pressureReadings = pressureUpdates = 0;
+  #endif
+  #if (BREWMODE == 2 || ONLYPIDSCALE == 1)
+    static unsigned long lastWeightSamples = 0;
+    unsigned long samples = LoadCell.getSampleCount();
+    debugStream.writeV("SCALE: weight=%.1f g samples=%lu in 10 s age=%lu ms flow=%.2f g/s latency=%.2f s",weight,samples - lastWeightSamples,(micros() - LoadCell.getSampleTime()) / 1000,flowRate,scaleStopLatency);
+    lastWeightSamples = samples;
+  #endif
+  for (int i = 0; TempSensor == 1 && i < tempSensors.count(); i++) {
+    const TempSensorBus::Sensor& s = tempSensors.sensor(i);
+    debugStream.writeV("DS18B20 %u: %.2f C valid=%u weight=%.2f failures=%lu",i,s.celsius,s.valid,tempSensorWeights[i],(unsigned long)s.failures);
   }
-  
-  return false;
 }
 
 /********************************************************
-   machinestatevoid
+  Debug console: tasks, scheduler statistics since the
+  last call
 ******************************************************/
+#if (DEBUGMETHOD == 1 || DEBUGMETHOD == 2)
+void printTaskStats()
+{
+  debugA("");
+  debugA(" *** scheduler tasks ***");
+  debugA("  task         every   prio      runs  overruns  deferred  jitter max   run avg   run max");
+  for (int i = 0; i < scheduler.tasks(); i++)
+  {
+    const Scheduler::Task& t = scheduler.task(i);
+    debugA("  %-12s %5lu ms %4u %9lu %9lu %9lu %8lu ms %7lu us %7lu us", t.name, t.intervalMs, t.priority,
+      (unsigned long)t.runs, (unsigned long)t.overruns, (unsigned long)t.deferrals, t.maxJitterMs, t.avgRunUs, t.maxRunUs);
+  }
+  debugA("");
+  scheduler.resetStats();
+}
 
-void machinestatevoid() 
+/********************************************************
+  Debug console: network, state of the links and
+  statistics since the last call
+******************************************************/
+void printConnectionStats()
 {
-  //DEBUG_println(machinestate);
-  switch (machinestate) 
+  debugA("");
+  debugA(" *** network links ***");
+  debugA("  link     state       for s  attempts  connects  failures  in row   drops  backoff  connecting  in calls  call max");
+  for (int i = 0; i < connection.links(); i++)
   {
-    // init
-    case kInit: 
-      if (Input < (BrewSetPoint-1) || Input < 150 ) // Prevent coldstart leave by Input 222
-      {
-        machinestate = kColdStart;
-        DEBUG_println(Input);
-        DEBUG_println(machinestate);
-      }
-      
-      if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kColdStart: 
-      switch (machinestatecold) 
-      // one high Input let the state jump to 19. 
-      // switch (machinestatecold) prevent it, we wait 10 sec with new state. 
-      // during the 10 sec the Input has to be Input >= (BrewSetPoint-1),
-      // If not, reset machinestatecold
-      {
-        case 0:
-          if (Input >= (BrewSetPoint-1) && Input < 150 ) 
-          {
-            machinestatecoldmillis = millis(); // get millis for interval calc
-            machinestatecold = 10 ; // new state 
-            debugStream.writeV("Input >= (BrewSetPoint-1), wait 10 sec before machinestate 19");
+    const ConnectionManager::Link& l = connection.link(i);
+    debugA("  %-8s %-10s %6lu %9lu %9lu %9lu %7lu %7lu %6lu s %8lu ms %6lu ms %6lu us", l.name,
+      ConnectionManager::stateName(l.state), (millis() - l.sinceMs) / 1000, (unsigned long)l.attempts,
+      (unsigned long)l.connects, (unsigned long)l.failures, (unsigned long)l.failedInRow, (unsigned long)l.drops,
+      l.backoffMs / 1000, l.connectingMs, l.callUs / 1000, l.maxCallUs);
+  }
+  debugA("");
+  connection.resetStats();
+}
 
-          }
-          break;
-        case 10: 
-          if (Input < (BrewSetPoint-1))
-          {
-            machinestatecold = 0 ;//  Input was only one time above BrewSetPoint, reset machinestatecold
-            debugStream.writeV("Reset timer for machinestate 19: Input < (BrewSetPoint-1)");
-          }
-          if (machinestatecoldmillis+10*1000 < millis() ) // 10 sec Input above BrewSetPoint, no set new state 
-          { 
-            machinestate = kSetPointNegative ;
-            debugStream.writeV("10 sec Input >= (BrewSetPoint-1) finished, switch to state 19");
-          }
-          break;
-      }
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
+/********************************************************
+  Debug console: DS18B20 in bus order with address,
+  weight in the PID input and statistics since the last
+  call
+******************************************************/
+void printTempSensors()
+{
+  debugA("");
+  debugA(" *** DS18B20 sensors ***");
+  if (TempSensor != 1) {
+    debugA("  TEMPSENSOR is not 1 (DS18B20)");
+    return;
+  }
+  debugA("  #  address           weight    temp C  valid  readings  failures  in row");
+  for (int i = 0; i < tempSensors.count(); i++)
+  {
+    const TempSensorBus::Sensor& s = tempSensors.sensor(i);
+    debugA("  %u  %02X%02X%02X%02X%02X%02X%02X%02X %6.2f %9.2f %6s %9lu %9lu %7lu", i,
+      s.address[0], s.address[1], s.address[2], s.address[3], s.address[4], s.address[5], s.address[6],
+      s.address[7], tempSensorWeights[i], s.celsius, s.valid ? "yes" : "no", (unsigned long)s.readings,
+      (unsigned long)s.failures, (unsigned long)s.failedInRow);
+  }
+  debugA("  last set %lu ms ago", millis() - tempSensors.setMs());
+  debugA("");
+  tempSensors.resetStats();
+}
 
-      if
-      (
-       (bezugsZeit > 0 && ONLYPID == 1) || // Bezugszeit bei Only PID  
-       (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42) 
-      )
-      
-      {
-        machinestate = kBrew;
-      }
+/********************************************************
+  Debug console: sensor check, readings per verdict and
+  the longest run of one value since the last call
+******************************************************/
+void printSensorFilter()
+{
+  debugA("");
+  debugA(" *** sensor check ***");
+  debugA("  median %.2f C, scale %.3f C, limit %.2f C, window %u", sensorFilter.median(), sensorFilter.scale(),
+    SENSORFILTERLIMIT * sensorFilter.scale(), SENSORFILTERWINDOW);
+  debugA("  valid %lu, out of range %lu, spike %lu, stuck %lu", sensorVerdicts[0], sensorVerdicts[1],
+    sensorVerdicts[2], sensorVerdicts[3]);
+  debugA("  same value %u readings in a row (%u heating), longest %u (stuck at %lu heating)", sensorFilter.run(),
+    sensorFilter.drivenRun(), sensorFilter.maxRun(), SENSORSTUCKTIME * 1000UL / intervaltempmes);
+  debugA("  consecutive errors %i, sensorError %i, sensorStuck %i", error, sensorError, sensorStuck);
+  debugA("");
+  for (int i = 0; i < 4; i++) sensorVerdicts[i] = 0;
+  sensorFilter.resetMaxRun();
+}
+#endif
 
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
+void setup() {
+  DEBUGSTART(115200);
+  debugStream.setup();
+  #if (DEBUGMETHOD == 1 || DEBUGMETHOD == 2)
+    debugStream.addCommand("statetrace", "statetrace - show the last machine state transitions", &printStateTrace);
+  #endif
 
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-     if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-      break;
-      // Setpoint -1 Celsius
-      case kSetPointNegative: 
-      if (Input >= (BrewSetPoint))
-      {
-        machinestate = kPidNormal;
-      }
-      if
-      (
-       (bezugsZeit > 0 && ONLYPID == 1) || // Bezugszeit bei Only PID  
-       (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42) 
-      )
-      {
-        machinestate = kBrew;
-      }
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-    
-     if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }  
-    break;
-
-    case kPidNormal: 
-      brewdetection();  //if brew detected, set PID values
-      if
-      (
-       (bezugsZeit > 0 && ONLYPID == 1) || // Bezugszeit bei Only PID  
-       (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42) 
-      )
-      {
-        machinestate = kBrew;
-      }
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-      if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-     if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kBrew:
-      brewdetection();  
-      // Ausgabe waehrend des Bezugs von Bruehzeit, Temp und heatrateaverage
-      if (logbrew.check())
-          debugStream.writeV("(tB,T,hra) --> %5.2f %6.2f %8.2f",(double)(millis() - startZeit)/1000,Input,heatrateaverage);
-      if
-      (
-       (bezugsZeit > 35*1000 && Brewdetection == 1 && ONLYPID == 1  ) ||  // 35 sec later and BD PID active SW Solution
-       (bezugsZeit == 0      && Brewdetection == 3 && ONLYPID == 1  ) ||  // Voltagesensor reset bezugsZeit == 0
-       ((brewcounter == 10 || brewcounter == 43)   && ONLYPID == 0  ) // After brew
-      )
-      {
-       if ((ONLYPID == 1 && Brewdetection == 3) || ONLYPID == 0 ) // only delay of shotimer for voltagesensor or brewcounter
-       {
-         machinestate = kShotTimerAfterBrew ;
-         lastbezugszeitMillis = millis() ; // for delay
-        
-       }
-       if (ONLYPID == 1 && Brewdetection == 1 && timerBrewdetection == 1) //direct to PID BD
-       {
-         machinestate = kBrewDetectionTrailing ;
-       }
-      } 
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-      if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-     if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kShotTimerAfterBrew: //lastbezugszeitMillis
-    brewdetection();  
-      if ( millis()-lastbezugszeitMillis > BREWSWITCHDELAY )
-      {
-       debugStream.writeI("Bezugsdauer: %4.1f s",lastbezugszeit/1000);
-       machinestate = kBrewDetectionTrailing ;
-       lastbezugszeit = 0 ;
-      }
-
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-     if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-      if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-
-     if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kBrewDetectionTrailing:
-      brewdetection();
-      if (timerBrewdetection == 0)
-      {
-        machinestate = kPidNormal;
-      }
-      if
-      (
-       (bezugsZeit > 0 && ONLYPID == 1  && Brewdetection == 3) || // New Brew inner BD only by Only PID AND Voltage Sensor
-       (ONLYPID == 0 && brewcounter > 10 && brewcounter <= 42) 
-      )
-      {
-        machinestate = kBrew;
-      }
-      
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-      if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-      if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-     if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kSteam:
-      if (SteamON == 0)
-      {
-        machinestate = kCoolDown;
-      }
-
-       if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-      if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-      if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;  
-
-    case kCoolDown:
-    if (Brewdetection == 2 || Brewdetection == 3) 
-      {
-        /*
-          Bei QuickMill Dampferkennung nur ueber Bezugsschalter moeglich, durch Aufruf von 
-          brewdetection() kann neuer Dampfbezug erkannt werden
-          */ 
-        brewdetection();
-      }
-      if (Brewdetection == 1 && ONLYPID == 1)
-      {
-        // Ab lokalen Minumum wieder freigeben für state 20, dann wird bist Solltemp geheizt.
-         if (heatrateaverage > 0 && Input < BrewSetPoint + 2) 
-         {
-            machinestate = kPidNormal;
-         } 
-      }
-      if ((Brewdetection == 3 || Brewdetection == 2) && Input < BrewSetPoint + 2) 
-      {
-        machinestate = kPidNormal;
-      }
-
-      if (SteamON == 1)
-      {
-        machinestate = kSteam;
-      }
-
-      if (backflushON || backflushState > 10) 
-      {
-        machinestate = kBackflush;
-      }
-
-      if (emergencyStop)
-      {
-        machinestate = kEmergencyStop;
-      }
-      if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-      if(sensorError)
-      {
-        machinestate = kSensorError;
-      }
-    break;
-
-    case kBackflush:
-      if (backflushON == 0)
-       {
-         machinestate = kPidNormal;
-       }
-
-      if (emergencyStop)
-       {
-         machinestate = kEmergencyStop;
-       }
-      if (pidON == 0)
-       {
-         machinestate = kPidOffline;
-       }
-      if(sensorError)
-       {
-         machinestate = kSensorError;
-       }
-    break;
-
-    case kEmergencyStop: 
-      if (!emergencyStop)
-      {
-        machinestate = kPidNormal;
-      }
-      if (pidON == 0)
-      {
-        machinestate = kPidOffline;
-      }
-      if(sensorError)
-      {
-        machinestate = kSensorError ;
-      }
-    break;
-
-    case kPidOffline: 
-      if (pidON == 1)
-      {
-        if(kaltstart) 
-        {
-          machinestate = kColdStart;
-        }
-        else if(!kaltstart && (Input > (BrewSetPoint-10) )) // Input higher BrewSetPoint-10, normal PID
-        {
-          machinestate = kPidNormal;
-        } 
-        else if (Input <= (BrewSetPoint-10) )
-        {
-          machinestate = kColdStart; // Input 10C below set point, enter cold start
-          kaltstart = true;
-        }
-      }
-
-      if(sensorError)
-      {
-        machinestate = kSensorError ;
-      }
-    break;
-
-    case kSensorError:
-      machinestate = kSensorError ;
-    break;
-  } // switch case
-
-  if (machinestate != lastmachinestate) { 
-    debugStream.writeI("new machinestate: %i -> %i", lastmachinestate, machinestate);
-    lastmachinestate = machinestate;
-  }
-} // end void
-
-void debugVerboseOutput()
-{
-  static PeriodicTrigger trigger(10000);
-  if(trigger.check()) 
-  {
-    debugStream.writeV("Tsoll=%5.1f  Tist=%5.1f Machinestate=%2i KP=%4.2f KI=%4.2f KD=%4.2f",BrewSetPoint,Input,machinestate,bPID.GetKp(),bPID.GetKi(),bPID.GetKd());
-  }
-}
-
-void setup() {
-  DEBUGSTART(115200);
-  debugStream.setup();
-
-  EEPROM.begin(1024);
+  EEPROM.begin(1024);
 
   if (MQTT == 1) {
     //MQTT
     snprintf(topic_will, sizeof(topic_will), "%s%s/%s", mqtt_topic_prefix, hostname, "will");
     snprintf(topic_set, sizeof(topic_set), "%s%s/+/%s", mqtt_topic_prefix, hostname, "set");
+    snprintf(mqtt_topic, sizeof(mqtt_topic), "%s%s/", mqtt_topic_prefix, hostname);
+    mqtt_topic_len = strlen(mqtt_topic);
+    #if MQTT_BATCH == 1
+      mqtt.setBufferSize(sizeof(mqtt_batch) + 128);  // topic and header
+    #endif
     mqtt.setServer(mqtt_server_ip, mqtt_server_port);
     mqtt.setCallback(mqtt_callback);
-    checkMQTT();
+    mqtt.setSocketTimeout(mqttSocketTimeout);
   }
 
   /********************************************************
@@ -1709,6 +1788,10 @@ void setup() {
   if (BREWDETECTION == 3) // IF Voltage sensor selected 
   { 
     pinMode(PINVOLTAGESENSOR, PINMODEVOLTAGESENSOR);
+    #if !(PINVOLTAGESENSOR == 16 && defined(ESP8266))
+      pumpPulses.begin(digitalRead(PINVOLTAGESENSOR) == VoltageSensorON, micros());
+      attachInterrupt(digitalPinToInterrupt(PINVOLTAGESENSOR), voltageSensorISR, CHANGE);
+    #endif
   }
   if (PINBREWSWITCH > 0) // IF PINBREWSWITCH & Steam selected 
   { 
@@ -1754,7 +1837,8 @@ void setup() {
   ******************************************************/
   if (TOF != 0) { 
   lox.begin(tof_i2c); // initialize TOF sensor at I2C address
-  lox.setMeasurementTimingBudgetMicroSeconds(2000000);
+  lox.setMeasurementTimingBudgetMicroSeconds(TOFBUDGET);
+  lox.startRangeContinuous(TOFPERIOD);  // ranges on its own, checkWaterLevel() collects
   }
 
   /********************************************************
@@ -1765,7 +1849,6 @@ void setup() {
     #if defined(ESP8266)
       WiFi.hostname(hostname);
     #endif
-    unsigned long started = millis();
     #if DISPLAY != 0
       displayLogo(langstring_connectwifi1, ssid);
     #endif
@@ -1774,21 +1857,28 @@ void setup() {
       network-issues with your other WiFi-devices on your WiFi-network. */
     WiFi.mode(WIFI_STA);
     WiFi.persistent(false);   //needed, otherwise exceptions are triggered \o.O/
-    WiFi.begin(ssid, pass);
     #if defined(ESP32) // ESP32
      WiFi.setHostname(hostname); // for ESP32port
     #endif
     debugStream.writeI("Connecting to %s ...",ssid);
 
-    // wait up to 20 seconds for connection:
-    while ((WiFi.status() != WL_CONNECTED) && (millis() - started < 20000))
+    // wait for WiFi, offline mode after maxWifiReconnects failed attempts
+    connection.add("wifi", wifiStart, wifiConnected, wifiConnectTimeout);
+    uint32_t attempts = 0;
+    while (!connection.up(kLinkWifi) && connection.link(kLinkWifi).failedInRow < maxWifiReconnects)
     {
+      connection.poll();
+      if (connection.link(kLinkWifi).attempts != attempts)
+      {
+        attempts = connection.link(kLinkWifi).attempts;
+        #if DISPLAY != 0
+          if (attempts > 1) displayMessage("", "", "", "", langstring_wifirecon, String(attempts - 1));
+        #endif
+      }
       yield();    //Prevent Watchdog trigger
     }
 
-    checkWifi();    //try to reconnect
-
-    if (WiFi.status() == WL_CONNECTED)
+    if (connection.up(kLinkWifi))
     {
       debugStream.writeI("WiFi connected - IP = %i.%i.%i.%i",WiFi.localIP()[0],WiFi.localIP()[1],WiFi.localIP()[2],WiFi.localIP()[3]);
       debugStream.writeI("Wifi works, now try Blynk (timeout 30s)");
@@ -1848,9 +1938,18 @@ void setup() {
           #endif 
         } 
       }
+
+      // from now on networkTask() keeps the links up
+      connection.setMaxBackoff(maxConnectionBackoff);
+      connection.add("blynk", blynkStart, blynkConnected, blynkConnectTimeout, kLinkWifi);
+      if (MQTT == 1)
+      {
+        connection.add("mqtt", mqttStart, mqttConnected, mqttConnectTimeout, kLinkWifi);
+      }
     }
     else 
     { 
+      initOfflineMode();
       #if DISPLAY != 0
         displayLogo(langstring_nowifi[0], langstring_nowifi[1]); 
       #endif
@@ -1885,11 +1984,11 @@ void setup() {
   ******************************************************/
   if (TempSensor == 1) 
   {
-    sensors.begin();
-    sensors.getAddress(sensorDeviceAddress, 0);
-    sensors.setResolution(sensorDeviceAddress, 10) ;
-    sensors.requestTemperatures();
-    Input = sensors.getTempCByIndex(0);
+    tempSensors.begin(TEMPSENSORS, DS18B20RESOLUTION);  // waits for the first conversion
+    float reading = DEVICE_DISCONNECTED_C;
+    tempSensors.mix(tempSensorWeights, reading);
+    Input = reading;
+    tempSensors.convert();  // from now on pollTempSensors() collects, refreshTemp() restarts
   }
   if (TempSensor == 2) 
   {
@@ -1902,20 +2001,14 @@ void setup() {
         Input = Sensor2.getTemp();
     #endif
   }
+  sensorInput = Input;
+  #if (TEMPOBSERVER == 1)
+    tempObserver.reset(Input);
+  #endif
        
       
   
   
-  /********************************************************
-    movingaverage ini array
-  ******************************************************/
-  if (Brewdetection == 1) {
-    for (int thisReading = 0; thisReading < numReadings; thisReading++) {
-      readingstemp[thisReading] = 0;
-      readingstime[thisReading] = 0;
-      readingchangerate[thisReading] = 0;
-    }
-  }
   /*
   if (TempSensor == 2) {
     temperature = 0;
@@ -1928,22 +2021,64 @@ void setup() {
      #endif
   } */
 
+  /********************************************************
+     Scheduler tasks
+  ******************************************************/
+  scheduler.setControlPriority(kTaskControl);   // sensor polls do not hold the network back
+  scheduler.add("temperature", refreshTemp, intervaltempmes, kTaskControl);
+  if (TempSensor == 1)
+  {
+    scheduler.add("ds18b20", pollTempSensors, 0, kTaskSensor);
+  }
+  #if (ONE_WIRE_BUS == 16 && TEMPSENSOR == 2 && defined(ESP8266))
+    scheduler.add("tsic", pollTsic, 0, kTaskSensor);
+  #endif
+  if (BREWDETECTION == 3)
+  {
+    scheduler.add("voltagesensor", pollVoltageSensor, 0, kTaskSensor);
+  }
+  #if (BREWMODE == 2 || ONLYPIDSCALE == 1)
+    scheduler.add("scale", checkWeight, intervalWeight, kTaskSensor);
+    scheduler.add("flow", checkFlow, intervalFlow, kTaskSensor);
+  #endif
+  #if (PRESSURESENSOR == 1)
+    pressureDecimator.reset(analogRead(PINPRESSURESENSOR));
+    scheduler.add("pressure", checkPressure, intervalPressure, kTaskSensor);
+  #endif
+  if (TOF != 0)
+  {
+    scheduler.add("waterlevel", checkWaterLevel, intervalTOF, kTaskSensor);
+  }
+  if (ETRIGGER == 1)
+  {
+    scheduler.add("etrigger", ETriggervoid, 1000, kTaskSensor);
+  }
+  #if DISPLAY != 0
+    scheduler.add("shottimer", displayShottimer, 100, kTaskDisplay);
+    scheduler.add("display", refreshDisplay, intervalDisplay, kTaskDisplay);
+  #endif
+  scheduler.add("verbose", debugVerboseOutput, 10000, kTaskInfo);
+  scheduler.add("network", networkTask, 0, kTaskNetwork, true);
+  scheduler.add("blynk", sendToBlynk, intervalBlynk, kTaskNetwork, true);
+  #if (DEBUGMETHOD == 1 || DEBUGMETHOD == 2)
+    debugStream.addCommand("tasks", "tasks - show scheduler statistics", &printTaskStats);
+    debugStream.addCommand("network", "network - show WiFi, Blynk and MQTT links", &printConnectionStats);
+    debugStream.addCommand("sensors", "sensors - show the DS18B20 on the bus", &printTempSensors);
+    debugStream.addCommand("sensorfilter", "sensorfilter - show the sensor check verdicts", &printSensorFilter);
+    #if (PROFILER == 1)
+      debugStream.addCommand("profile", "profile - show and clear loop stage timing", &printProfile);
+    #endif
+  #endif
+
   //Initialisation MUST be at the very end of the init(), otherwise the time comparision in loop() will have a big offset
   unsigned long currentTime = millis();
-  previousMillistemp = currentTime;
   windowStartTime = currentTime;
-  previousMillisDisplay = currentTime;
-  previousMillisBlynk = currentTime;
   previousMillisETrigger = currentTime; 
   previousMillisVoltagesensorreading = currentTime;
-  #if (BREWMODE ==  2) 
-  previousMillisScale = currentTime;
-  #endif
-  #if (PRESSURESENSOR == 1)
-  previousMillisPressure = currentTime;
-  #endif
+  scheduler.start();
   setupDone = true;
 
+  controlTask();
   initTimer1();
   enableTimer1();
 }
@@ -1954,8 +2089,8 @@ void loop() {
   } else {
       looppid();
       debugStream.handle();
-      debugVerboseOutput();
     }
+  controlTask();
 }
 
 // TOF Calibration_mode 
@@ -1968,110 +2103,123 @@ void loopcalibrate()
     bPID.SetMode(pidMode);
     Output = 0;
   }
-  if (Blynk.connected()) 
-  {  // If connected run as normal
-      Blynk.run();
-      blynkReCnctCount = 0; //reset blynk reconnects if connected
-  } else  
-  {
-    checkBlynk();
-  }
+  networkTask();
     digitalWrite(pinRelayHeater, LOW); //Stop heating to be on the safe side ...
 
   unsigned long currentMillisTOF = millis();
   if (currentMillisTOF - previousMillisTOF >= intervalTOF) 
   {
     previousMillisTOF = millis() ;
-    VL53L0X_RangingMeasurementData_t measure;  //TOF Sensor measurement
-    lox.rangingTest(&measure, false); // pass in 'true' to get debug data printout!
-    distance = measure.RangeMilliMeter;  //write new distence value to 'distance'
-    DEBUG_print(distance);
-    DEBUG_println("mm");
-    #if DISPLAY !=0
-        displayDistance(distance);
-    #endif
+    unsigned long ranges = tofRanges;
+    checkWaterLevel();
+    if (tofRanges != ranges)
+    {
+      DEBUG_print(distance);
+      DEBUG_println("mm");
+      #if DISPLAY !=0
+          displayDistance(distance);
+      #endif
+    }
   }  
 }
 
 
-void looppid() 
+/********************************************************
+  Scheduler task on every pass: WiFi, MQTT, OTA and Blynk
+*****************************************************/
+void networkTask()
 {
+  if (Offlinemodus == 1) return;
+
+  connection.hold(brewcounter > 11);   // no new attempts while brewing
+  connection.poll();
+
   //Only do Wifi stuff, if Wifi is connected
-  if (WiFi.status() == WL_CONNECTED && Offlinemodus == 0) 
-  { 
-    //MQTT
-    if (MQTT == 1) 
-    {
-      checkMQTT();
-      if (mqtt.connected() == 1)
-      {
-        mqtt.loop();
-      }
-    }
-    ArduinoOTA.handle();  // For OTA
-    // Disable interrupt it OTA is starting, otherwise it will not work
-    ArduinoOTA.onStart([]() 
-    {
-      disableTimer1();
-      digitalWrite(pinRelayHeater, LOW); //Stop heating
-    });
-    ArduinoOTA.onError([](ota_error_t error) 
-    {
-      enableTimer1();
-    });
-    // Enable interrupts if OTA is finished
-    ArduinoOTA.onEnd([]() 
-    {
-      enableTimer1();
-    });
-
-    if (Blynk.connected()) 
-    {  // If connected run as normal
-      Blynk.run();
-      blynkReCnctCount = 0; //reset blynk reconnects if connected
-    } else  
-    {
-      checkBlynk();
-    }
-    wifiReconnects = 0;   //reset wifi reconnects if connected
-  } else 
+  if (!connection.up(kLinkWifi)) return;
+
+  //MQTT
+  if (connection.up(kLinkMqtt))
   {
-    checkWifi();
+    PROFILE_SCOPE(profileMqtt);
+    mqtt.loop();
   }
-  if (TOF != 0) 
+  ArduinoOTA.handle();  // For OTA
+  // Disable interrupt it OTA is starting, otherwise it will not work
+  ArduinoOTA.onStart([]() 
   {
-        unsigned long currentMillisTOF = millis();
-      if (currentMillisTOF - previousMillisTOF >= intervalTOF) 
-      {
-        previousMillisTOF = millis() ;
-        VL53L0X_RangingMeasurementData_t measure;  //TOF Sensor measurement
-        lox.rangingTest(&measure, false); // pass in 'true' to get debug data printout!
-        distance = measure.RangeMilliMeter;  //write new distence value to 'distance'
-        if (distance <= 1000)
-        {
-          percentage = (100.00 / (water_empty - water_full)) * (water_empty - distance); //calculate percentage of waterlevel
-          DEBUG_println(percentage);
-        }
-      }
+    disableTimer1();
+    digitalWrite(pinRelayHeater, LOW); //Stop heating
+  });
+  ArduinoOTA.onError([](ota_error_t error) 
+  {
+    enableTimer1();
+  });
+  // Enable interrupts if OTA is finished
+  ArduinoOTA.onEnd([]() 
+  {
+    enableTimer1();
+  });
+
+  // also finishes the login of a connection attempt, not before the probe
+  // handed over: Blynk.run() would connect on its own and block
+  if (connection.up(kLinkBlynk) || (blynkLogin && connection.link(kLinkBlynk).state == ConnectionManager::kLinkConnecting))
+  {
+    PROFILE_SCOPE(profileBlynkRun);
+    Blynk.run();
   }
+}
+
+/********************************************************
+  Scheduler task every intervalTOF ms: water level
+  The sensor ranges continuously, every TOFPERIOD ms;
+  this only asks whether a range is done (one I2C read)
+  and collects it. Ranges without target or beyond 1 m
+  are dropped, distance is the median of the last
+  TOFMEDIAN valid ones, so single reflections do not
+  move the water level.
+*****************************************************/
+void checkWaterLevel()
+{
+  if (!lox.isRangeComplete()) return;
+  uint16_t range = lox.readRangeResult();  // 0xffff: no valid range
+  tofRanges++;
+  if (distanceFilter.check(range) == SensorFilter<TOFMEDIAN>::kOutOfRange)
+  {
+    tofInvalid++;
+    return;
+  }
+  distance = distanceFilter.median();  //write new distence value to 'distance'
+  percentage = (100.00 / (water_empty - water_full)) * (water_empty - distance); //calculate percentage of waterlevel
+}
+
+#if DISPLAY != 0
+/********************************************************
+  Scheduler task every intervalDisplay ms
+*****************************************************/
+void refreshDisplay()
+{
+  PROFILE_SCOPE(profileDisplay);
+  #if DISPLAYTEMPLATE < 20 // not in vertikal template
+    Displaymachinestate() ;
+  #endif
+  printScreen();  // refresh display
+}
+#endif
+
+void looppid() 
+{
+  PROFILE_SCOPE(profileLoop);
+
+  // periodic jobs: temperature, sensors, display, network
+  scheduler.run();
+
   // voids
-  refreshTemp();   //read new temperature values
   testEmergencyStop();  // test if Temp is to high
-  #if (BREWMODE == 2 || ONLYPIDSCALE == 1 )
-    checkWeight() ; // Check Weight Scale in the loop
-  #endif
-    #if (PRESSURESENSOR == 1)
-    checkPressure();
-    #endif
   brew();   //start brewing if button pressed
   checkSteamON(); // check for steam
   setEmergencyStopTemp();
-  sendToBlynk();
   machinestatevoid() ; // calc machinestate
-  if (ETRIGGER == 1) // E-Trigger active then void Etrigger() 
-  { 
-    ETriggervoid();
-  }  
+  brewFeedForward();
   #if (ONLYPIDSCALE == 1) // only by shottimer 2, scale
       shottimerscale() ;
   #endif
@@ -2079,22 +2227,6 @@ void looppid()
 
   //check if PID should run or not. If not, set to manuel and force output to zero
   // OFFLINE
-  //voids Display & BD
-  #if DISPLAY != 0
-      unsigned long currentMillisDisplay = millis();
-      if (currentMillisDisplay - previousMillisDisplay >= 100) 
-      {
-        displayShottimer() ;
-      }
-      if (currentMillisDisplay - previousMillisDisplay >= intervalDisplay)
-      {
-        previousMillisDisplay = currentMillisDisplay;
-        #if DISPLAYTEMPLATE < 20 // not in vertikal template
-          Displaymachinestate() ;
-        #endif
-        printScreen();  // refresh display
-      }
-  #endif
   if (machinestate == kPidOffline || machinestate == kSensorError || machinestate == kEmergencyStop) // Offline see machinestate.h
   {
     if (pidMode == 1)
@@ -2115,102 +2247,25 @@ void looppid()
     }
   }
 
-  //Set PID if first start of machine detected, and no SteamON
-  if (machinestate == kInit || machinestate == kColdStart || machinestate == kSetPointNegative) // Cold Start states 
-  {
-    if (startTn != 0) {
-      startKi = startKp / startTn;
-    } else {
-      startKi = 0 ;
-    }
-    if (lastmachinestatepid != machinestate)
-    {
-      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",startKp,startKi,0);
-      lastmachinestatepid = machinestate;
-    }
-    bPID.SetTunings(startKp, startKi, 0, P_ON_M);
-  // normal PID
-  } 
-  if (machinestate == kPidNormal ) 
-  {    //Prevent overwriting of brewdetection values
-    // calc ki, kd
-    if (aggTn != 0) {
-      aggKi = aggKp / aggTn ;
-    } else {
-      aggKi = 0 ;
-    }
-    aggKd = aggTv * aggKp ;
-    if (lastmachinestatepid != machinestate)
-    {
-      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggKp,aggKi,aggKd);
-      lastmachinestatepid = machinestate;
-    }
-    bPID.SetTunings(aggKp, aggKi, aggKd, PonE);
-    kaltstart = false;
-  }
-  // BD PID
-  if (machinestate >= 30 && machinestate <= 35)  
+  // autotune switches the heater itself, the PID takes over bumpless afterwards
+  if (machinestate == kAutotune)
   {
-    // calc ki, kd
-    if (aggbTn != 0) {
-      aggbKi = aggbKp / aggbTn ;
-    } else {
-      aggbKi = 0 ;
-    }
-    aggbKd = aggbTv * aggbKp ;
-    if (lastmachinestatepid != machinestate)
+    if (bPID.GetMode() == AUTOMATIC)
     {
-      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggbKp,aggbKi,aggbKd);
-      lastmachinestatepid = machinestate;
+      bPID.SetMode(MANUAL);
     }
-    bPID.SetTunings(aggbKp, aggbKi, aggbKd, PonE) ;
+    Output = autotune.update(Input);
   }
-  // Steam on
-  if (machinestate == kSteam) // STEAM
+  else if (pidMode == 1 && bPID.GetMode() == MANUAL)
   {
-    // if (aggTn != 0) {
-    //   aggKi = aggKp / aggTn ;
-    // } else {
-    //   aggKi = 0 ;
-    // }
-    // aggKi = 0 ;
-    // aggKd = aggTv * aggKp ;
-    if (lastmachinestatepid != machinestate)
-    {
-      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",150,0,0);
-      lastmachinestatepid = machinestate;
-    }
-    bPID.SetTunings(150, 0, 0, PonE);
+    bPID.SetMode(AUTOMATIC);
   }
 
-  if (machinestate == kCoolDown) // chill-mode after steam
+  // tunings change with the machine state (machinestateTransition()) or a new gain
+  if (pidTuningsChanged)
   {
-    switch (machine) {
-      
-      case QuickMill:
-        aggbKp = 150;
-        aggbKi = 0;
-        aggbKd = 0;
-      break;
-      
-      default:
-        // calc ki, kd
-        if (aggbTn != 0) {
-          aggbKi = aggbKp / aggbTn;
-        } else {
-          aggbKi = 0;
-        }
-        aggbKd = aggbTv * aggbKp;
-    }
-
-    if (lastmachinestatepid != machinestate)
-    {
-      debugStream.writeI("new PID-Values: P=%.1f  I=%.1f  D=%.1f",aggbKp,aggbKi,aggbKd);
-      lastmachinestatepid = machinestate;
-    }
-    bPID.SetTunings(aggbKp, aggbKi, aggbKd, PonE) ;
-  }  
-  //sensor error OR Emergency Stop
+    setPidTunings(machinestate);
+  }
 }
 
 
@@ -2260,6 +2315,13 @@ int readSysParamsFromStorage(void)
   EEPROM.get(110, aggbTv);
   EEPROM.get(120, brewtimersoftware);
   EEPROM.get(130, brewboarder);
+  #if (COLDSTART_PID == 2)  // 2=?Blynk values, else default starttemp from config
+  // not written by older versions, erased storage reads as NaN
+  EEPROM.get(140, dummy);
+  if (!isnan(dummy)) startKp = dummy;
+  EEPROM.get(150, dummy);
+  if (!isnan(dummy)) startTn = dummy;
+  #endif
 
   // EEPROM.commit() not necessary after read
   return 0;
@@ -2291,6 +2353,8 @@ int writeSysParamsToStorage(void)
   EEPROM.put(110, aggbTv);
   EEPROM.put(120, brewtimersoftware);
   EEPROM.put(130, brewboarder);
+  EEPROM.put(140, startKp);
+  EEPROM.put(150, startTn);
 
   // While Flash memory erase/write operations no other code must be executed from Flash!
   // disable any ISRs...
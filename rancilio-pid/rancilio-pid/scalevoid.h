@@ -1,27 +1,70 @@
 
 /********************************************************
-  CheckWeight
+  CheckWeight, scheduler task every intervalWeight ms
+  SCALEINTERRUPT 0: reads a conversion if there is one
+  SCALEINTERRUPT 1: scaleISR() has read every conversion
+  already, only takes the new average
 ******************************************************/
 #if (BREWMODE == 2 || ONLYPIDSCALE == 1)
+  #if (SCALEINTERRUPT == 1)
+  /********************************************************
+    DOUT of the HX711 falls when a conversion is ready,
+    read it out right away (25 clocks, about 50 us) into
+    the dataset of HX711_ADC. DOUT toggles while clocking,
+    the edges this raises find it high and return at once.
+  ******************************************************/
+  void ICACHE_RAM_ATTR scaleISR() {
+    LoadCell.update();
+  }
+  #endif
+
   void checkWeight() {
-    static boolean newDataReady = 0;
-    unsigned long currentMillisScale = millis();
+    PROFILE_SCOPE(profileScale);
     if (scaleFailure) {   // abort if scale is not working
       return;
     }
-    if (currentMillisScale - previousMillisScale >= intervalWeight)
-    {
-      previousMillisScale = currentMillisScale;
 
+    #if (SCALEINTERRUPT == 0)
       // check for new data/start next conversion:
-      if (LoadCell.update()) {
-        newDataReady = true;
-      }
+      LoadCell.update();
+    #endif
+
+    // get smoothed value from the dataset. scaleISR() may store a conversion
+    // while getData() sums the dataset; it runs on this core, so an unchanged
+    // sample count around getData() means nothing came in between
+    unsigned long samples;
+    do {
+      samples = LoadCell.getSampleCount();
+      if (samples == weightSamples) return;
+      weight = LoadCell.getData();
+    } while (LoadCell.getSampleCount() != samples);
+    weightSamples = samples;
+  }
 
-      // get smoothed value from the dataset:
-      if (newDataReady) {
-        weight = LoadCell.getData();
-        newDataReady = 0;
+  /********************************************************
+    checkFlow, scheduler task every intervalFlow ms
+    flowRate is the least squares slope of the weight over
+    the last second. After a stop by weight, the weight the
+    cup gained until it settled over the flow at the stop is
+    the stop latency of this shot (pump, valve, puck, scale
+    and estimator lag); scaleStopLatency moves halfway
+    towards it.
+  ******************************************************/
+  void checkFlow() {
+    if (scaleFailure) {
+      return;
+    }
+    flowEstimator.add(weight);
+    flowRate = flowEstimator.slope();
+
+    if (stopMillis != 0 && millis() - stopMillis > scaleSettleTime) {
+      stopMillis = 0;
+      float drip = weight - weightPreBrew - weightAtStop;
+      if (flowAtStop > 0.5 && drip > 0) {
+        float latency = drip / flowAtStop;
+        scaleStopLatency += 0.5 * (latency - scaleStopLatency);
+        scaleStopLatency = constrain(scaleStopLatency, 0, 5);
+        debugStream.writeI("Brew by weight: %.1f g after stop at %.1f g/s, latency %.2f s",drip,flowAtStop,scaleStopLatency);
       }
     }
   }
@@ -34,26 +77,38 @@
     long stabilizingtime = 2000; // tare preciscion can be improved by adding a few seconds of stabilizing time
     boolean _tare = true; //set this to false if you don't want tare to be performed in the next step
     DEBUG_print(F("INIT: Initializing scale ... "));
-    u8g2.clearBuffer();
-    u8g2.drawStr(0, 2, "Taring scale,");
-    u8g2.drawStr(0, 12, "remove any load!");
-    u8g2.drawStr(0, 22, "....");
-    delay(2000);
-    u8g2.sendBuffer();
+    #if DISPLAY != 0
+      u8g2.clearBuffer();
+      u8g2.drawStr(0, 2, "Taring scale,");
+      u8g2.drawStr(0, 12, "remove any load!");
+      u8g2.drawStr(0, 22, "....");
+      delay(2000);
+      u8g2.sendBuffer();
+    #endif
     LoadCell.start(stabilizingtime, _tare);
     if (LoadCell.getTareTimeoutFlag()) {
       DEBUG_println(F("Timeout, check MCU>HX711 wiring and pin designations"));
-      u8g2.drawStr(0, 32, "failed!");
-      u8g2.drawStr(0, 42, "Scale not working...");    // scale timeout will most likely trigger after OTA update, but will still work after boot
-      delay(5000);
-      u8g2.sendBuffer();
+      #if DISPLAY != 0
+        u8g2.drawStr(0, 32, "failed!");
+        u8g2.drawStr(0, 42, "Scale not working...");    // scale timeout will most likely trigger after OTA update, but will still work after boot
+        delay(5000);
+        u8g2.sendBuffer();
+      #endif
     }
     else {
       DEBUG_println(F("done"));
-      u8g2.drawStr(0, 32, "done.");
-      u8g2.sendBuffer();
+      #if DISPLAY != 0
+        u8g2.drawStr(0, 32, "done.");
+        u8g2.sendBuffer();
+      #endif
     }
     LoadCell.setCalFactor(calibrationValue); // set calibration factor (float)
+    weight = LoadCell.getData();             // also what setSamplesInUse() fills the dataset with
+    LoadCell.setSamplesInUse(SCALESAMPLES);  // tare with all samples, weigh with these
+    flowEstimator.reset(weight);
+    #if (SCALEINTERRUPT == 1)
+      attachInterrupt(digitalPinToInterrupt(HXDATPIN), scaleISR, FALLING);
+    #endif
   }
 
   void shottimerscale()
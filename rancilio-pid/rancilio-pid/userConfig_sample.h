@@ -54,11 +54,33 @@ enum MACHINE {
 #define TRIGGERTYPE HIGH           // LOW = low trigger, HIGH = high trigger relay
 #define VOLTAGESENSORTYPE HIGH     // BREWDETECTION 3 configuration
 #define PINMODEVOLTAGESENSOR INPUT // Mode INPUT_PULLUP, INPUT or INPUT_PULLDOWN_16 (Only Pin 16)
+#define PVSMERGETIME 30            // ms, pump on until the voltage sensor was off this long (> 20 ms: sensors without smoothing pass the 50 Hz half waves)
+#define PVSBREWTIME 200            // ms, pump runs this long: brew or cooling flush, shorter pulses: steam (QuickMill)
+#define PVSSTEAMGAP 1500           // ms, no pump pulse for this long: steam-mode ends (QuickMill)
 #define PRESSURESENSOR 0           // 1 = pressure sensor connected to A0; PINBREWSWITCH must be set to the connected input!
+#define FEEDFORWARD 0              // 1 = extra heater power from the start of a shot (ONLYPID 0 or BREWDETECTION 3 only)
+#define HEATERPOWER 1000           // heater power in W, for FEEDFORWARD and TEMPOBSERVER
+#define BREWFLOW 2.0               // ml/s water drawn from the boiler during a shot, for FEEDFORWARD
+#define INLETTEMP 20               // temperature of the refill water in Celsius, for FEEDFORWARD
+#define FEEDFORWARDTIME 30         // s, decay time of the feed-forward during the shot
+#define PID_FIXEDPOINT 0           // 1 = integer PID calculation (PID_fixed, faster on ESP8266), 0 = floating point (PID_v1)
+#define HEATERPWMMODE 0            // 0 = one heater pulse per 1000 ms PID window, 1 = on-time spread over the window in single ticks (smoother power, SSR only)
+#define TEMPOBSERVER 0             // 1 = PID and software brew detection use a boiler model fused with the sensor (less noise and lag), 0 = raw sensor reading
+#define BOILERCAPACITY 1700        // J/K, heat capacity of boiler and water, for TEMPOBSERVER (Silvia: 1700)
+#define BOILERLOSS 0.9             // W/K, heat loss of the boiler to the ambient, for TEMPOBSERVER
+#define SENSORTAU 5                // s, time constant of the temperature sensor mounting, for TEMPOBSERVER
+#if defined(ESP32)
+#define HEATERTICK 10              // heater switching tick in ms (>= 10 and a divisor of 1000)
+#else
+#define HEATERTICK 20              // heater switching tick in ms (>= 10 and a divisor of 1000)
+#endif
 
 // TOF sensor for water level
 #define TOF 0                      // 0 = no TOF sensor connected; 1 = water level by TOF sensor
 #define TOF_I2C 0x29               // I2C address of TOF sensor; 0x29 by default
+#define TOFBUDGET 200000           // us per range, longer is less noise (200000 = high accuracy)
+#define TOFPERIOD 1000             // ms between ranges, at least TOFBUDGET
+#define TOFMEDIAN 5                // water level from the median of this many ranges
 #define CALIBRATION_MODE 0         // 1 = enable to obtain water level calibration values; 0 = disable for normal PID operation; can also be done in Blynk
 #define WATER_FULL 102             // value for full water tank (=100%) obtained in calibration procedure (in mm); can also be set in Blynk
 #define WATER_EMPTY 205            // value for empty water tank (=0%) obtained in calibration procedure (in mm); can also be set in Blynk
@@ -70,6 +92,7 @@ enum MACHINE {
 
 //Weight SCALE
 #define WEIGHTSETPOINT 30          // Gramm 
+#define SCALESTOPLATENCY 1.2       // s of flow that still reaches the scale after the brew stopped, start value, learned per shot
 
 //Pressure sensor
 /*
@@ -79,6 +102,8 @@ enum MACHINE {
 #define OFFSET      102            // 10% of ADC input @3.3V supply = 102
 #define FULLSCALE   922            // 90% of ADC input @3.3V supply = 922
 #define MAXPRESSURE 200
+#define PRESSURESAMPLETIME 1       // ms between ADC readings of the pressure sensor, raise it if WiFi suffers from the ADC reads (ESP8266)
+#define PRESSUREDECIMATION 20      // ADC readings per pressure value (1 ms * 20 = 50 values/s, low-pass against the pump pulsation)
 
 /// Wifi 
 #define HOSTNAME "wifi-hostname"
@@ -87,6 +112,7 @@ enum MACHINE {
 #define MAXWIFIRECONNECTS 5        // maximum number of reconnection attempts, use -1 to deactivate
 #define WIFICINNECTIONDELAY 10000  // delay between reconnects in ms
 #define DEBUGMETHOD 1              // 0 = none, 1 = SerialDebug, 2 = RemoteDebug
+#define PROFILER 0                 // 1 = run time of the loop stages, command "profile" in the debug console; 0 = not compiled
 #define MAXLOGLINES 100            // Number of log lines (>=0) stored in logbook, (-> command "loghist" in terminal window)
                                    // if set too large the ESP will run out of memory and reboot unexpectedly
 
@@ -102,6 +128,9 @@ enum MACHINE {
 #define MQTT_TOPIC_PREFIX "custom/Küche."  // topic will be "<MQTT_TOPIC_PREFIX><HOSTNAME>/<READING>"
 #define MQTT_SERVER_IP "XXX.XXX.XXX.XXX"  // IP-Address of locally installed mqtt server
 #define MQTT_SERVER_PORT 1883    
+#define TELEMETRYDEADBAND 1        // 1 = Blynk and MQTT values only when they changed (at least every TELEMETRYHEARTBEAT s), 0 = every cycle
+#define TELEMETRYHEARTBEAT 60      // s, longest time a value is not sent with TELEMETRYDEADBAND 1
+#define MQTT_BATCH 0               // 1 = the readings of one Blynk cycle as one JSON message to "<MQTT_TOPIC_PREFIX><HOSTNAME>/telemetry", 0 = one topic per reading
 
 // BLynk
 #define AUTH "blynk_auth"
@@ -112,6 +141,7 @@ enum MACHINE {
 #define SETPOINT 95                // Temperatur setpoint
 #define STEAMSETPOINT 120          // Temperatur setpoint
 #define BREWDETECTIONLIMIT 150     // brew detection limit, be carefull: if too low, then there is the risk of wrong brew detection and rising temperature
+#define BREWDETECTIONWINDOW 15    // readings (400 ms each, 800 ms with a 12 bit DS18B20) for the heat rate of the brew detection, fewer = faster but noisier
 #define AGGKP 69                   // Kp normal
 #define AGGTN 399                  // Tn
 #define AGGTV 0                    // Tv
@@ -125,6 +155,10 @@ enum MACHINE {
 #define AGGBTN 0                   // Tn 
 #define AGGBTV 20                  // Tv
 
+// PID autotune (Blynk V41), overwrites the three PID value sets above in the eeprom
+#define AUTOTUNE_OUTPUT 300        // heater on-time in ms per 1000 ms window while the boiler is below setpoint
+#define AUTOTUNE_HYSTERESIS 0.2    // Celsius around the setpoint before the heater is switched
+
 // Backflush values
 #define FILLTIME 3000              // time in ms the pump is running
 #define FLUSHTIME 6000             // time in ms the 3-way valve is open -> backflush
@@ -145,12 +179,20 @@ enum MACHINE {
 #define OLED_SDA 4                 // Output pin for dispaly data pin
 #define HXDATPIN 99                // weight scale PIN 
 #define HXCLKPIN 99                // weight scale PIN  
+#define SCALEINTERRUPT 0           // 1 = read the HX711 from a DOUT interrupt (HXDATPIN not 16), with its RATE pin high for 80 samples/s
+#define SCALESAMPLES 16            // HX711 samples averaged for the weight, 1, 2, 4, 8 or 16 (16 = 1.6 s at 10 samples/s, use 4 at 80)
 #define SCREEN_WIDTH 128           // OLED display width, in pixels
 #define SCREEN_HEIGHT 64           // OLED display height, in pixels  
 
 // Historic (no settings)
 #define PONE 1                     // 1 = P_ON_E (default), 0 = P_ON_M (special PID mode, other PID-parameter are needed)
 #define TEMPSENSOR 2               // 2 = TSIC306 1=DS18B20
+#define DS18B20RESOLUTION 10       // 9-12 bit, TEMPSENSOR 1: a reading every 400 ms, with 12 bit every 800 ms
+#define TEMPSENSORS 1              // TEMPSENSOR 1: up to 4 DS18B20 on ONE_WIRE_BUS (boiler, group head, steam boiler), one conversion for all
+#define SENSORFILTERWINDOW 7       // readings in the median of the sensor check, odd, 5-15, a step is accepted after (window + 1) / 2 readings
+#define SENSORFILTERLIMIT 3        // reading is a spike if further than this times the MAD spread (at least 0.3 C) from the median
+#define SENSORSTUCKTIME 300        // s, the same value for this long while the heater runs at least half the time = stuck sensor (logged), 0 = off
+#define TEMPSENSORWEIGHTS {1}      // share of each DS18B20 (bus order, console "sensors") in the PID input, e.g. {0, 1} = group head only, SETPOINT is then the group head temperature
 
 // Check BrewSwitch
 #if (defined(ESP8266) && ((PINBREWSWITCH != 15 && PINBREWSWITCH != 0 && PINBREWSWITCH != 16 )))
@@ -0,0 +1,76 @@
+#include "BoilerModel.h"
+
+#include <math.h>
+
+namespace {
+
+const double waterHeatCapacity = 4.186;   // J/(g K), 1 ml = 1 g
+const uint64_t noiseSlotUs = 10000;       // new noise value every 10 ms
+
+uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+}
+
+BoilerParams::BoilerParams()
+    : heaterPowerW(1000),
+      elementCapJK(250),
+      elementToBoilerWK(80),
+      boilerCapJK(1700),
+      lossWK(0.9),
+      ambientC(20),
+      inletC(20),
+      sensorTauS(5),
+      sensorNoiseC(0.02),
+      startC(20),
+      seed(1)
+{
+}
+
+BoilerModel::BoilerModel(const BoilerParams& params)
+    : m_params(params),
+      m_heaterOn(false),
+      m_flowMlS(0),
+      m_elementC(params.startC),
+      m_boilerC(params.startC),
+      m_sensorC(params.startC),
+      m_noiseC(0),
+      m_heaterEnergyJ(0),
+      m_waterDrawnMl(0)
+{
+}
+
+void BoilerModel::step(uint64_t nowUs, double dtS)
+{
+    const BoilerParams& p = m_params;
+
+    double heaterW = m_heaterOn ? p.heaterPowerW : 0;
+    double toBoilerW = p.elementToBoilerWK * (m_elementC - m_boilerC);
+    double lossW = p.lossWK * (m_boilerC - p.ambientC);
+    double drawW = m_flowMlS * waterHeatCapacity * (m_boilerC - p.inletC);
+
+    m_elementC += (heaterW - toBoilerW) / p.elementCapJK * dtS;
+    m_boilerC += (toBoilerW - lossW - drawW) / p.boilerCapJK * dtS;
+    m_sensorC += (m_boilerC - m_sensorC) * (dtS / (p.sensorTauS + dtS));
+
+    m_heaterEnergyJ += heaterW * dtS;
+    m_waterDrawnMl += m_flowMlS * dtS;
+    m_noiseC = noise(nowUs);
+}
+
+/* Gaussian noise as a pure function of time, so the noise sequence does
+   not depend on how often or when the firmware reads the sensor. */
+double BoilerModel::noise(uint64_t nowUs) const
+{
+    if (m_params.sensorNoiseC <= 0) return 0;
+
+    uint64_t r = splitmix64(m_params.seed * 0x2545F4914F6CDD1DULL + nowUs / noiseSlotUs);
+    double u1 = ((r >> 11) + 1.0) / 9007199254740993.0;
+    double u2 = (splitmix64(r) >> 11) / 9007199254740992.0;
+    return m_params.sensorNoiseC * sqrt(-2 * log(u1)) * cos(2 * M_PI * u2);
+}
@@ -0,0 +1,69 @@
+/********************************************************
+  Lumped thermal model of an espresso machine boiler
+
+  Three heat capacities: heating element, boiler (water
+  and brass) and temperature sensor. Heat flows
+    heater -> element -> boiler -> ambient
+    boiler -> water drawn during a shot (refilled at inlet
+              temperature)
+    boiler -> sensor (first order lag)
+  Defaults roughly match a Rancilio Silvia.
+******************************************************/
+
+#ifndef BoilerModel_h
+#define BoilerModel_h
+
+#include <stdint.h>
+
+struct BoilerParams {
+    BoilerParams();
+
+    double heaterPowerW;        // heating element power
+    double elementCapJK;        // heat capacity of the element
+    double elementToBoilerWK;   // conductance element -> boiler water
+    double boilerCapJK;         // heat capacity of water and boiler body
+    double lossWK;              // conductance boiler -> ambient
+    double ambientC;            // ambient temperature
+    double inletC;              // temperature of the refill water
+    double sensorTauS;          // time constant of the sensor mounting
+    double sensorNoiseC;        // standard deviation of the sensor noise
+    double startC;              // initial temperature of all nodes
+    uint64_t seed;              // seed of the sensor noise
+};
+
+class BoilerModel {
+  public:
+    explicit BoilerModel(const BoilerParams& params);
+
+    void setHeater(bool on) { m_heaterOn = on; }
+    void setFlow(double mlPerS) { m_flowMlS = mlPerS; }
+
+    void step(uint64_t nowUs, double dtS);
+
+    double boilerC() const { return m_boilerC; }
+    double elementC() const { return m_elementC; }
+    double sensorC() const { return m_sensorC; }
+    double sensorReadingC() const { return m_sensorC + m_noiseC; }
+
+    bool heaterOn() const { return m_heaterOn; }
+    double flowMlS() const { return m_flowMlS; }
+    double heaterEnergyJ() const { return m_heaterEnergyJ; }
+    double waterDrawnMl() const { return m_waterDrawnMl; }
+
+    const BoilerParams& params() const { return m_params; }
+
+  private:
+    double noise(uint64_t nowUs) const;
+
+    BoilerParams m_params;
+    bool m_heaterOn;
+    double m_flowMlS;
+    double m_elementC;
+    double m_boilerC;
+    double m_sensorC;
+    double m_noiseC;
+    double m_heaterEnergyJ;
+    double m_waterDrawnMl;
+};
+
+#endif
@@ -0,0 +1,266 @@
+#include "SimHardware.h"
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <string.h>
+
+namespace sim {
+
+namespace {
+
+// ESP8266 core constants, see Arduino.h in the shim directory
+const uint8_t modeOutput = 0x01;
+const int isrRising = 1;
+const int isrFalling = 2;
+const int isrChange = 3;
+
+double timer1TickUs(uint8_t divider)
+{
+    switch (divider) {
+        case 0: return 1.0 / 80;    // TIM_DIV1
+        case 1: return 1.0 / 5;     // TIM_DIV16
+        default: return 3.2;        // TIM_DIV256
+    }
+}
+
+}
+
+Hardware& Hardware::instance()
+{
+    static Hardware hardware;
+    return hardware;
+}
+
+uint32_t Hardware::hostCycleCount(uint32_t cpuMHz) const
+{
+#if defined(__x86_64__) || defined(__i386__)
+    // the TSC is as cheap as CCOUNT on the ESP, the clock call is not
+    (void)cpuMHz;
+    return (uint32_t)__rdtsc();
+#endif
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+    return (uint32_t)(ns * cpuMHz / 1000);
+}
+
+Hardware::Hardware()
+    : m_nowUs(0), m_plantUs(0), m_advancing(false), m_interruptsEnabled(true), m_analogReads(0),
+      m_timer1Isr(NULL), m_timer1Ticks(0), m_timer1TickUs(3.2),
+      m_timer1Enabled(false), m_timer1Armed(false), m_timer1DueUs(0),
+      m_plant(NULL)
+{
+    memset(m_mode, 0, sizeof(m_mode));
+    memset(m_level, 0, sizeof(m_level));
+    memset(m_analog, 0, sizeof(m_analog));
+    memset(m_pinIsr, 0, sizeof(m_pinIsr));
+    memset(m_pinIsrMode, 0, sizeof(m_pinIsrMode));
+    memset(&m_timer1Stats, 0, sizeof(m_timer1Stats));
+    for (int i = 0; i < numTemperatures; i++) m_temperature[i] = 20;
+    m_scaleGrams = 0;
+    m_waterDistanceMm = 0;
+}
+
+/********************************************************
+  Time
+******************************************************/
+void Hardware::advance(uint64_t us)
+{
+    uint64_t target = m_nowUs + us;
+
+    // delay() called from an event handler must not recurse into the queue
+    if (m_advancing) {
+        stepPlant(target);
+        m_nowUs = target;
+        return;
+    }
+    m_advancing = true;
+
+    for (;;) {
+        bool timerDue = m_timer1Armed && m_timer1DueUs <= target;
+        bool eventDue = !m_events.empty() && m_events.begin()->first <= target;
+
+        if (!timerDue && !eventDue) break;
+
+        if (timerDue && (!eventDue || m_timer1DueUs <= m_events.begin()->first)) {
+            stepPlant(m_timer1DueUs);
+            m_nowUs = m_timer1DueUs;
+            fireTimer1();
+        } else {
+            std::multimap<uint64_t, std::function<void()> >::iterator it = m_events.begin();
+            std::function<void()> event = it->second;
+            stepPlant(it->first);
+            m_nowUs = it->first;
+            m_events.erase(it);
+            event();
+        }
+    }
+
+    stepPlant(target);
+    m_nowUs = target;
+    m_advancing = false;
+}
+
+void Hardware::stepPlant(uint64_t toUs)
+{
+    if (!m_plant) {
+        m_plantUs = toUs;
+        return;
+    }
+    while (m_plantUs < toUs) {
+        uint64_t dt = toUs - m_plantUs;
+        if (dt > maxPlantStepUs) dt = maxPlantStepUs;
+        m_plantUs += dt;
+        m_plant->step(m_plantUs, dt / 1e6);
+    }
+}
+
+void Hardware::schedule(uint64_t atUs, std::function<void()> event)
+{
+    if (atUs < m_nowUs) atUs = m_nowUs;
+    m_events.insert(std::make_pair(atUs, event));
+}
+
+/********************************************************
+  GPIO / ADC
+******************************************************/
+void Hardware::pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= numPins) return;
+    m_mode[pin] = mode;
+}
+
+int Hardware::digitalRead(uint8_t pin) const
+{
+    if (pin >= numPins) return 0;
+    return m_level[pin];
+}
+
+void Hardware::digitalWrite(uint8_t pin, int value)
+{
+    if (pin >= numPins) return;
+    if (m_mode[pin] != modeOutput) {
+        // like on the ESP8266, writing an input pin has no visible effect
+        return;
+    }
+    setLevel(pin, value ? 1 : 0);
+}
+
+int Hardware::analogRead(uint8_t pin) const
+{
+    if (pin >= numPins) return 0;
+    m_analogReads++;
+    return m_analog[pin];
+}
+
+void Hardware::setDigitalInput(uint8_t pin, int value)
+{
+    if (pin >= numPins || m_mode[pin] == modeOutput) return;
+    setLevel(pin, value ? 1 : 0);
+}
+
+void Hardware::setAnalogInput(uint8_t pin, int value)
+{
+    if (pin >= numPins) return;
+    m_analog[pin] = value;
+}
+
+int Hardware::pinLevel(uint8_t pin) const
+{
+    if (pin >= numPins) return 0;
+    return m_level[pin];
+}
+
+void Hardware::setLevel(uint8_t pin, int level)
+{
+    int old = m_level[pin];
+    m_level[pin] = level;
+
+    if (old == level || !m_pinIsr[pin] || !m_interruptsEnabled) return;
+
+    int mode = m_pinIsrMode[pin];
+    if (mode == isrChange || (mode == isrRising && level) || (mode == isrFalling && !level)) {
+        m_pinIsr[pin]();
+    }
+}
+
+void Hardware::attachInterrupt(uint8_t pin, IsrHandler isr, int mode)
+{
+    if (pin >= numPins) return;
+    m_pinIsr[pin] = isr;
+    m_pinIsrMode[pin] = mode;
+}
+
+void Hardware::detachInterrupt(uint8_t pin)
+{
+    if (pin >= numPins) return;
+    m_pinIsr[pin] = NULL;
+}
+
+/********************************************************
+  timer1
+******************************************************/
+void Hardware::timer1AttachInterrupt(IsrHandler isr)
+{
+    m_timer1Isr = isr;
+}
+
+void Hardware::timer1Write(uint32_t ticks)
+{
+    m_timer1Ticks = ticks;
+    if (m_timer1Enabled) {
+        m_timer1DueUs = m_nowUs + (uint64_t)(ticks * m_timer1TickUs + 0.5);
+        m_timer1Armed = true;
+    }
+}
+
+void Hardware::timer1Enable(uint8_t divider, uint8_t intType, uint8_t reload)
+{
+    (void)intType;
+    (void)reload;    // TIM_SINGLE only, the ISR re-arms itself with timer1_write()
+    m_timer1TickUs = timer1TickUs(divider);
+    m_timer1Enabled = true;
+    timer1Write(m_timer1Ticks);
+}
+
+void Hardware::timer1Disable()
+{
+    m_timer1Enabled = false;
+    m_timer1Armed = false;
+}
+
+void Hardware::fireTimer1()
+{
+    m_timer1Armed = false;
+    if (!m_timer1Isr) return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_timer1Isr();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    m_timer1Stats.add(ns);
+}
+
+void IsrStats::add(uint64_t ns)
+{
+    calls++;
+    totalNs += ns;
+    if (ns > maxNs) maxNs = ns;
+    uint64_t bucket = ns / bucketNs;
+    histogram[bucket < (uint64_t)numBuckets ? bucket : numBuckets - 1]++;
+}
+
+uint64_t IsrStats::percentileNs(double percent) const
+{
+    unsigned long rank = (unsigned long)(calls * percent / 100);
+    unsigned long seen = 0;
+    for (int i = 0; i < numBuckets; i++) {
+        seen += histogram[i];
+        if (seen > rank) return (uint64_t)(i + 1) * bucketNs;
+    }
+    return maxNs;
+}
+
+}
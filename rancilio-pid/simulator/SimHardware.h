@@ -0,0 +1,139 @@
+/********************************************************
+  Simulated ESP8266 hardware for the host build
+
+  Owns the simulated clock, GPIO/ADC state, the timer1
+  interrupt and a small event queue. Time only moves when
+  advance() is called (from delay(), yield() or the
+  simulator main loop); pending interrupts and scheduled
+  events fire in timestamp order while time advances.
+******************************************************/
+
+#ifndef SimHardware_h
+#define SimHardware_h
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+
+namespace sim {
+
+typedef void (*IsrHandler)();
+
+/* Continuous-time part of the rig (boiler, pump, sensors).
+   step() is called in chunks of at most maxPlantStepUs. */
+class Plant {
+  public:
+    virtual ~Plant() {}
+    virtual void step(uint64_t nowUs, double dtS) = 0;
+};
+
+/* Host-side cost of one interrupt handler */
+struct IsrStats {
+    static const int bucketNs = 10;
+    static const int numBuckets = 2000;   // last bucket collects everything >= 20 us
+
+    unsigned long calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    unsigned long histogram[numBuckets];
+
+    void add(uint64_t ns);
+    uint64_t percentileNs(double percent) const;
+};
+
+/* Serial/debug output of the sketch, off by default */
+void setLogEnabled(bool enabled);
+bool logEnabled();
+
+class Hardware {
+  public:
+    static const int numPins = 40;
+    static const uint32_t maxPlantStepUs = 10000;
+
+    static Hardware& instance();
+
+    uint64_t micros() const { return m_nowUs; }
+    void advance(uint64_t us);
+
+    // GPIO / ADC
+    void pinMode(uint8_t pin, uint8_t mode);
+    int digitalRead(uint8_t pin) const;
+    void digitalWrite(uint8_t pin, int value);
+    int analogRead(uint8_t pin) const;
+    void setDigitalInput(uint8_t pin, int value);
+    void setAnalogInput(uint8_t pin, int value);
+    int pinLevel(uint8_t pin) const;
+    unsigned long analogReads() const { return m_analogReads; }   // ADC conversions so far
+
+    // GPIO interrupts (attachInterrupt)
+    void attachInterrupt(uint8_t pin, IsrHandler isr, int mode);
+    void detachInterrupt(uint8_t pin);
+
+    // timer1 (ESP8266 API)
+    void timer1AttachInterrupt(IsrHandler isr);
+    void timer1Write(uint32_t ticks);
+    void timer1Enable(uint8_t divider, uint8_t intType, uint8_t reload);
+    void timer1Disable();
+    bool timer1Enabled() const { return m_timer1Enabled; }
+    const IsrStats& timer1Stats() const { return m_timer1Stats; }
+
+    void interruptsEnabled(bool enabled) { m_interruptsEnabled = enabled; }
+
+    // ESP.getCycleCount(): TSC on x86 hosts, else wall clock as a cpuMHz CPU
+    uint32_t hostCycleCount(uint32_t cpuMHz) const;
+
+    // generic events, used by sensor and actuator models
+    void schedule(uint64_t atUs, std::function<void()> event);
+
+    void setPlant(Plant* plant) { m_plant = plant; }
+
+    // temperature seen by sensor #channel, written by the plant
+    static const int numTemperatures = 4;
+    double temperature(int channel) const { return m_temperature[channel % numTemperatures]; }
+    void setTemperature(int channel, double celsius) { m_temperature[channel % numTemperatures] = celsius; }
+
+    // load on the scale in grams, written by the plant
+    double scaleGrams() const { return m_scaleGrams; }
+    void setScaleGrams(double grams) { m_scaleGrams = grams; }
+
+    // distance from the TOF sensor to the water in the tank, written by the plant
+    double waterDistanceMm() const { return m_waterDistanceMm; }
+    void setWaterDistanceMm(double mm) { m_waterDistanceMm = mm; }
+
+  private:
+    Hardware();
+
+    void stepPlant(uint64_t toUs);
+    void fireTimer1();
+    void setLevel(uint8_t pin, int level);
+
+    uint64_t m_nowUs;
+    uint64_t m_plantUs;
+    bool m_advancing;
+    bool m_interruptsEnabled;
+
+    uint8_t m_mode[numPins];
+    int m_level[numPins];
+    int m_analog[numPins];
+    mutable unsigned long m_analogReads;
+    IsrHandler m_pinIsr[numPins];
+    int m_pinIsrMode[numPins];
+
+    IsrHandler m_timer1Isr;
+    uint32_t m_timer1Ticks;
+    double m_timer1TickUs;
+    bool m_timer1Enabled;
+    bool m_timer1Armed;
+    uint64_t m_timer1DueUs;
+    IsrStats m_timer1Stats;
+
+    std::multimap<uint64_t, std::function<void()> > m_events;
+    Plant* m_plant;
+    double m_temperature[numTemperatures];
+    double m_scaleGrams;
+    double m_waterDistanceMm;
+};
+
+}
+
+#endif
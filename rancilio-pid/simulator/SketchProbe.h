@@ -0,0 +1,38 @@
+/********************************************************
+  Read access to sketch globals for the simulator.
+  Implemented in sketch.cpp, next to the sketch itself.
+******************************************************/
+
+#ifndef SketchProbe_h
+#define SketchProbe_h
+
+void setup();
+void loop();
+
+namespace probe {
+double input();
+double output();
+double setPoint();
+double brewSetPoint();
+int machineState();
+bool steamOn();
+double heatRate();   // heatrateaverage, 1/1000 C per s
+bool brewSwitch();
+unsigned long mqttPublishes();
+unsigned long mqttBytes();
+double pressure();
+double waterLevel();
+double kp();
+double ki();
+double kd();
+
+struct Gains {
+    double aggKp, aggTn, aggTv;
+    double startKp, startTn;
+    double aggbKp, aggbTn, aggbTv;
+};
+Gains gains();
+void startAutotune();
+}
+
+#endif
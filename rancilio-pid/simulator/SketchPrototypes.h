@@ -0,0 +1,33 @@
+/********************************************************
+  Function prototypes of rancilio-pid.ino
+
+  The Arduino builder generates these for .ino files; the
+  host build compiles the sketch as plain C++ and needs
+  them spelled out. Only functions that are used before
+  their definition have to be listed here.
+******************************************************/
+
+#ifndef SketchPrototypes_h
+#define SketchPrototypes_h
+
+#include <Arduino.h>
+#include "userConfig.h"
+
+bool mqtt_publish(const char *reading, char *payload);
+char* number2string(double in);
+char* number2string(float in);
+char* number2string(int in);
+char* number2string(unsigned int in);
+int readSysParamsFromStorage(void);
+int writeSysParamsToStorage(void);
+void initSteamQM();
+boolean checkSteamOffQM();
+void loopcalibrate();
+void looppid();
+void networkTask();
+void checkWaterLevel();
+void refreshDisplay();
+const char *getMachineName(enum MACHINE id);
+const char *getFwVersion(void);
+
+#endif
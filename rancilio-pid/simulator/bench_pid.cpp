@@ -0,0 +1,131 @@
+/********************************************************
+  PID engine benchmark: PID_v1 (double) against
+  PID_fixed (integer) on the same input trajectory.
+
+  Both controllers see identical Input/Setpoint values
+  and are called every 20 ms like the timer1 ISR does.
+  Reports the cost per Compute() call (TSC cycles on
+  x86, nanoseconds elsewhere) and the largest output
+  difference between the two engines.
+
+  The host has an FPU, so the gap is much smaller here
+  than on the ESP8266, where every double operation is
+  a soft-float library call.
+******************************************************/
+
+#include <Arduino.h>
+#include <PID_v1.h>
+#include <PID_fixed.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char* kTickUnit = "cycles";
+#else
+static inline uint64_t ticks()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* kTickUnit = "ns";
+#endif
+
+namespace {
+
+struct CallStats {
+    uint64_t calls = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+
+    void add(uint64_t t)
+    {
+        calls++;
+        total += t;
+        if (t > max) max = t;
+    }
+    double mean() const { return calls ? (double)total / calls : 0; }
+};
+
+struct EngineStats {
+    CallStats computed;
+    CallStats idle;
+};
+
+template <typename Engine>
+bool timedCompute(Engine& pid, EngineStats& stats)
+{
+    uint64_t start = ticks();
+    bool computed = pid.Compute();
+    uint64_t elapsed = ticks() - start;
+    (computed ? stats.computed : stats.idle).add(elapsed);
+    return computed;
+}
+
+void report(const char* name, const EngineStats& s)
+{
+    printf("%-10s compute %8.1f %s avg %8llu max (%llu calls)   idle %6.1f %s avg\n",
+           name, s.computed.mean(), kTickUnit, (unsigned long long)s.computed.max,
+           (unsigned long long)s.computed.calls, s.idle.mean(), kTickUnit);
+}
+
+}  // namespace
+
+int main()
+{
+    const int windowSize = 1000;
+    const double kp = 62, tn = 52, tv = 11.5;
+    const unsigned long durationMs = 4UL * 3600 * 1000;
+
+    double inputF = 20, outputF = 0, setPointF = 95;
+    double inputX = 20, outputX = 0, setPointX = 95;
+
+    PID pidF(&inputF, &outputF, &setPointF, kp, kp / tn, kp * tv, P_ON_E, DIRECT);
+    PIDFixed pidX(&inputX, &outputX, &setPointX, kp, kp / tn, kp * tv, P_ON_E, DIRECT);
+    pidF.SetSampleTime(windowSize);
+    pidX.SetSampleTime(windowSize);
+    pidF.SetOutputLimits(0, windowSize);
+    pidX.SetOutputLimits(0, windowSize);
+    pidF.SetMode(AUTOMATIC);
+    pidX.SetMode(AUTOMATIC);
+
+    EngineStats statsF, statsX;
+    double maxDiff = 0, sumDiff = 0;
+    unsigned long samples = 0;
+
+    // first order boiler driven by the double engine, setpoint steps
+    // every 20 minutes so the integral and derivative terms both work
+    double boiler = 20;
+    sim::Hardware& hw = sim::Hardware::instance();
+
+    for (unsigned long t = 0; t < durationMs; t += 20) {
+        setPointF = setPointX = ((t / 1200000) % 2) ? 93 : 95;
+        double noise = 0.02 * sin(t * 0.0037) + 0.01 * sin(t * 0.0191);
+        inputF = inputX = boiler + noise;
+
+        bool computed = timedCompute(pidF, statsF);
+        if (timedCompute(pidX, statsX) != computed) {
+            fprintf(stderr, "engines disagree on the sample time at %lu ms\n", t);
+            return 1;
+        }
+        if (computed) {
+            double diff = fabs(outputF - outputX);
+            if (diff > maxDiff) maxDiff = diff;
+            sumDiff += diff;
+            samples++;
+        }
+
+        double duty = outputF / windowSize;
+        boiler += 0.020 * (duty * 0.55 - (boiler - 20) * 0.0006);
+        hw.advance(20000);
+    }
+
+    report("PID_v1", statsF);
+    report("PID_fixed", statsX);
+    printf("output difference max %.4f mean %.5f (of %d, %lu samples)\n",
+           maxDiff, samples ? sumDiff / samples : 0, windowSize, samples);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/********************************************************
+  Sensor check benchmark: the old checkSensor() (0..150 C
+  and at most 5 C from the last valid reading) against
+  the SensorFilter used by the sketch now.
+
+  All see the same 400 ms readings, noisy and 0.1 C
+  quantised like the TSic:
+  - steady boiler with one spike every 20 s, 1 to 20 C:
+    spikes let through, good readings rejected
+  - steam: 95 -> 125 C at 1.5 C/s and back, a shot: 0.5
+    C/s down for 25 s, 0.2 C/s up: good readings rejected
+  - dropout: -127 C for 20 s while the boiler cools by
+    7 C: readings after the dropout until one is valid
+  - stuck sensor: the reading freezes while the boiler
+    keeps cycling: time until it is reported
+  - the cost per reading (TSC cycles on x86, ns elsewhere)
+******************************************************/
+
+#include <SensorFilter.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char* kTickUnit = "cycles";
+#else
+static inline uint64_t ticks()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* kTickUnit = "ns";
+#endif
+
+namespace {
+
+const double kIntervalS = 0.4;
+const unsigned int kStuckReadings = 750;  // SENSORSTUCKTIME 300 s
+
+// checkSensor() before the SensorFilter, previousInput is the last valid reading
+class OldCheck
+{
+  public:
+    OldCheck() : m_previous(0), m_first(true) {}
+
+    bool check(float value)
+    {
+        bool bad = value < 0 || value > 150 || fabs(value - m_previous) > 5;
+        if (m_first || !bad) m_previous = value;  // the first reading is always stored
+        m_first = false;
+        return !bad;
+    }
+
+  private:
+    float m_previous;
+    bool m_first;
+};
+
+template <int N>
+class NewCheck
+{
+  public:
+    NewCheck() : m_filter(0, 150, 3, 0.3, kStuckReadings) {}
+    bool check(float value) { return m_filter.check(value) == SensorFilter<N>::kValid; }
+
+  private:
+    SensorFilter<N> m_filter;
+};
+
+struct Result {
+    unsigned long spikesPassed;
+    unsigned long spikes;
+    unsigned long rejectedSteady;
+    unsigned long rejectedRamps;
+    int afterDropout;       // readings until valid again, < 0 = never
+    double stuckS;          // time until stuck is reported, < 0 = never
+    double ticksPerCheck;
+    size_t bytes;
+};
+
+struct Sensor {
+    Sensor() : rng(7), noise(0, 0.03) {}
+    float read(double boiler) { return round((boiler + noise(rng)) * 10) / 10; }
+    std::mt19937 rng;
+    std::normal_distribution<double> noise;
+};
+
+// boiler cycling around 95 C like the PID keeps it
+double boiler(double t) { return 95 + 0.12 * sin(t / 30 * 2 * M_PI); }
+
+template <typename Check>
+Result run()
+{
+    Result r = {};
+    Check c;
+    r.bytes = sizeof(Check);
+    Sensor sensor;
+    double t = 0;
+    uint64_t spent = 0;
+    unsigned long calls = 0;
+    const float spikes[] = { 1, 2, 3, 5, 8, 20 };
+
+    c.check(sensor.read(boiler(t)));
+    for (int i = 1; i < 30000; i++) {
+        t += kIntervalS;
+        float v = sensor.read(boiler(t));
+        bool spike = i % 50 == 0;
+        if (spike) v += spikes[(i / 50) % 6] * (i % 100 ? 1 : -1);
+        uint64_t start = ticks();
+        bool valid = c.check(v);
+        spent += ticks() - start;
+        calls++;
+        if (spike) {
+            r.spikes++;
+            if (valid) r.spikesPassed++;
+        } else if (!valid) {
+            r.rejectedSteady++;
+        }
+    }
+
+    // steam, back to 95 and a shot
+    double temp = 95;
+    for (; temp < 125; temp += 1.5 * kIntervalS) r.rejectedRamps += !c.check(sensor.read(temp));
+    for (; temp > 95; temp -= 1.5 * kIntervalS) r.rejectedRamps += !c.check(sensor.read(temp));
+    for (int i = 0; i < 200; i++) c.check(sensor.read(95));
+    for (; temp > 82.5; temp -= 0.5 * kIntervalS) r.rejectedRamps += !c.check(sensor.read(temp));
+    for (; temp < 95; temp += 0.2 * kIntervalS) r.rejectedRamps += !c.check(sensor.read(temp));
+    for (int i = 0; i < 400; i++) c.check(sensor.read(95));
+
+    for (int i = 0; i < 20 / kIntervalS; i++) c.check(-127);
+    r.afterDropout = -1;
+    for (int i = 1; i <= 100; i++) {
+        if (c.check(sensor.read(88))) {
+            r.afterDropout = i;
+            break;
+        }
+    }
+    for (int i = 0; i < 400; i++) c.check(sensor.read(88 + 7 * std::min(1.0, i / 100.0)));
+
+    r.stuckS = -1;
+    for (int i = 1; i <= 2000; i++) {
+        if (!c.check(94.3f)) {
+            r.stuckS = i * kIntervalS;
+            break;
+        }
+    }
+    r.ticksPerCheck = (double)spent / calls;
+    return r;
+}
+
+void report(const char* name, const Result& r)
+{
+    char dropout[16], stuck[16];
+    if (r.afterDropout < 0) snprintf(dropout, sizeof(dropout), "never");
+    else snprintf(dropout, sizeof(dropout), "%d", r.afterDropout);
+    if (r.stuckS < 0) snprintf(stuck, sizeof(stuck), "never");
+    else snprintf(stuck, sizeof(stuck), "%.0f s", r.stuckS);
+    printf("%-16s %3lu/%-3lu %7lu %7lu %9s %8s %7.1f %-6s %4zu bytes\n", name, r.spikesPassed, r.spikes,
+           r.rejectedSteady, r.rejectedRamps, dropout, stuck, r.ticksPerCheck, kTickUnit, r.bytes);
+}
+
+}  // namespace
+
+int main()
+{
+    printf("%-16s %7s %7s %7s %9s %8s %14s %10s\n", "", "spikes", "steady", "ramps", "dropout", "stuck",
+           "cost/reading", "state");
+    printf("%-16s %7s %7s %7s %9s %8s\n", "", "passed", "reject", "reject", "readings", "after");
+    report("checkSensor", run<OldCheck>());
+    report("SensorFilter 5", run<NewCheck<5> >());
+    report("SensorFilter 7", run<NewCheck<7> >());
+    report("SensorFilter 11", run<NewCheck<11> >());
+    report("SensorFilter 15", run<NewCheck<15> >());
+    return 0;
+}
@@ -0,0 +1,206 @@
+/********************************************************
+  Heat rate benchmark: the old movAvg() (15 two point
+  slopes, averaged by rescanning the array) against the
+  SlopeEstimator used by the sketch now.
+
+  Both see the same 400 ms temperature readings:
+  - steady boiler with sensor noise and 0.1 C steps,
+    reports the spread of the rate (false brew detection)
+  - a shot, the boiler starts falling with 0.5 C/s,
+    reports the time until the rate crosses the default
+    brew detection limit of -150 (1/1000 C per s)
+  - a boiler cooling with 0.1 C/s, reports the mean
+    rate (-100 if the rate is right)
+  - the cost per reading (TSC cycles on x86, ns elsewhere)
+  The "lost" rows drop every 4th reading, like readings
+  refreshTemp() rejects, once with add(value) and once
+  with add(value, ms).
+******************************************************/
+
+#include <SlopeEstimator.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ticks() { return __rdtsc(); }
+static const char* kTickUnit = "cycles";
+#else
+static inline uint64_t ticks()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const char* kTickUnit = "ns";
+#endif
+
+namespace {
+
+const unsigned long kIntervalMs = 400;
+const double kLimit = 150;
+
+// movAvg() before the SlopeEstimator, globals turned into members
+class OldMovAvg
+{
+  public:
+    static const int numReadings = 15;
+
+    void reset(double input)
+    {
+        for (int i = 0; i < numReadings; i++) {
+            readingstemp[i] = input;
+            readingstime[i] = 0;
+            readingchangerate[i] = 0;
+        }
+        readIndex = 1;
+    }
+
+    double add(double input, unsigned long now)
+    {
+        readingstime[readIndex] = now;
+        readingstemp[readIndex] = input;
+
+        double changerate;
+        if (readIndex == numReadings - 1) {
+            changerate = (readingstemp[numReadings - 1] - readingstemp[0]) /
+                         (readingstime[numReadings - 1] - readingstime[0]) * 10000;
+        } else {
+            changerate = (readingstemp[readIndex] - readingstemp[readIndex + 1]) /
+                         (readingstime[readIndex] - readingstime[readIndex + 1]) * 10000;
+        }
+        readingchangerate[readIndex] = changerate;
+        double total = 0;
+        for (int i = 0; i < numReadings; i++) total += readingchangerate[i];
+
+        readIndex = readIndex >= numReadings - 1 ? 0 : readIndex + 1;
+        return total / numReadings * 100;
+    }
+
+    double readingstemp[numReadings];
+    unsigned long readingstime[numReadings];
+    double readingchangerate[numReadings];
+    int readIndex;
+};
+
+template <int N, bool Timed = true>
+class NewSlope
+{
+  public:
+    NewSlope() : m_estimator(kIntervalMs) {}
+    void reset(double input) { m_estimator.reset(input); }
+    double add(double input, unsigned long now)
+    {
+        if (Timed)
+            m_estimator.add(input, now);
+        else
+            m_estimator.add(input);
+        return m_estimator.slope() * 1000;
+    }
+
+  private:
+    SlopeEstimator<N> m_estimator;
+};
+
+struct Result {
+    double rateStd;
+    double rateMax;      // largest |rate| while the boiler is steady
+    double latencyS;     // shot start to rate <= -limit, < 0 = never
+    double rampRate;     // mean rate while cooling with 0.1 C/s
+    double ticksPerAdd;
+    size_t bytes;
+};
+
+double sensor(double boiler, std::mt19937& rng)
+{
+    std::normal_distribution<double> noise(0, 0.03);
+    return round((boiler + noise(rng)) * 10) / 10;
+}
+
+// lostEvery: every lostEvery-th reading does not reach the estimator, 0 = none
+template <typename Rate>
+Result run(int lostEvery = 0)
+{
+    Result r = {};
+    Rate rate;
+    r.bytes = sizeof(Rate);
+    std::mt19937 rng(42);
+    unsigned long now = 0;
+    uint64_t spent = 0;
+    unsigned long calls = 0;
+
+    // the first reading initialises the window, as in refreshTemp()
+    now += kIntervalMs;
+    rate.reset(sensor(95, rng));
+
+    double sum = 0, sumSq = 0;
+    unsigned long n = 0;
+    for (int i = 0; i < 30000; i++) {
+        now += kIntervalMs;
+        double input = sensor(95, rng);
+        if (lostEvery && i % lostEvery == 0) continue;
+        uint64_t start = ticks();
+        double v = rate.add(input, now);
+        spent += ticks() - start;
+        calls++;
+        if (i < 100) continue;  // window filled
+        sum += v;
+        sumSq += v * v;
+        n++;
+        if (fabs(v) > r.rateMax) r.rateMax = fabs(v);
+    }
+    double mean = sum / n;
+    r.rateStd = sqrt(sumSq / n - mean * mean);
+
+    r.latencyS = -1;
+    for (int i = 1; i <= 100; i++) {
+        now += kIntervalMs;
+        double boiler = 95 - 0.5 * i * kIntervalMs / 1000.0;
+        double input = sensor(boiler, rng);
+        if (lostEvery && i % lostEvery == 0) continue;
+        if (rate.add(input, now) <= -kLimit) {
+            r.latencyS = i * kIntervalMs / 1000.0;
+            break;
+        }
+    }
+    r.ticksPerAdd = (double)spent / calls;
+
+    Rate ramp;
+    ramp.reset(sensor(95, rng));
+    sum = 0;
+    n = 0;
+    for (int i = 1; i <= 1000; i++) {
+        now += kIntervalMs;
+        double input = sensor(95 - 0.1 * i * kIntervalMs / 1000.0, rng);
+        if (lostEvery && i % lostEvery == 0) continue;
+        double v = ramp.add(input, now);
+        if (i <= 100) continue;  // window filled
+        sum += v;
+        n++;
+    }
+    r.rampRate = sum / n;
+    return r;
+}
+
+void report(const char* name, const Result& r)
+{
+    printf("%-18s %6.1f %6.1f   %5.1f s %7.1f   %6.1f %-6s %4zu bytes\n", name, r.rateStd, r.rateMax,
+           r.latencyS, r.rampRate, r.ticksPerAdd, kTickUnit, r.bytes);
+}
+
+}  // namespace
+
+int main()
+{
+    printf("%-18s %6s %6s   %7s %7s   %13s %10s\n", "", "std", "max", "detect", "ramp", "cost/reading", "state");
+    report("movAvg (15)", run<OldMovAvg>());
+    report("SlopeEstimator 6", run<NewSlope<6> >());
+    report("SlopeEstimator 10", run<NewSlope<10> >());
+    report("SlopeEstimator 15", run<NewSlope<15> >());
+    report("10, lost, untimed", run<NewSlope<10, false> >(4));
+    report("10, lost, timed", run<NewSlope<10> >(4));
+    return 0;
+}
@@ -0,0 +1,103 @@
+/********************************************************
+  VL53L0X stub for the host build
+
+  Ranges the water distance of the simulation. Noise
+  shrinks with the timing budget (3 mm at 33 ms, like
+  the datasheet's default mode); 2 % of the ranges hit a
+  reflection (30..400 mm) and 1 % find no target
+  (8190 mm, status 4). The blocking rangingTest() costs
+  the timing budget. Continuous mode ranges every
+  max(period, budget) on its own; isRangeComplete() and
+  readRangeResult() are one I2C transfer each (250 us).
+******************************************************/
+
+#ifndef ADAFRUIT_VL53L0X_H
+#define ADAFRUIT_VL53L0X_H
+
+#include "Arduino.h"
+
+#define VL53L0X_I2C_ADDR 0x29
+
+struct VL53L0X_RangingMeasurementData_t {
+    uint16_t RangeMilliMeter;
+    uint8_t RangeStatus;
+};
+
+class Adafruit_VL53L0X {
+  public:
+    Adafruit_VL53L0X() : m_budgetUs(33000), m_continuous(false), m_ready(false), m_range(0), m_status(0), m_rng(4321) {}
+
+    boolean begin(uint8_t = VL53L0X_I2C_ADDR, boolean = false) { return true; }
+    boolean setMeasurementTimingBudgetMicroSeconds(uint32_t budget_us) { m_budgetUs = budget_us; return true; }
+
+    void rangingTest(VL53L0X_RangingMeasurementData_t* data, boolean = false)
+    {
+        delayMicroseconds(m_budgetUs);
+        range(data->RangeMilliMeter, data->RangeStatus);
+    }
+
+    boolean startRangeContinuous(uint16_t period_ms = 50)
+    {
+        uint64_t periodUs = std::max<uint64_t>((uint64_t)period_ms * 1000, m_budgetUs);
+        if (!m_continuous) scheduleRange(sim::Hardware::instance().micros() + periodUs, periodUs);
+        m_continuous = true;
+        return true;
+    }
+
+    boolean isRangeComplete()
+    {
+        delayMicroseconds(250);
+        return m_ready;
+    }
+
+    uint16_t readRangeResult()
+    {
+        delayMicroseconds(250);
+        m_ready = false;
+        return m_status != 4 ? m_range : 0xffff;
+    }
+
+    uint8_t readRangeStatus() { return m_status; }
+
+  private:
+    void scheduleRange(uint64_t atUs, uint64_t periodUs)
+    {
+        sim::Hardware::instance().schedule(atUs, [this, atUs, periodUs]() {
+            range(m_range, m_status);
+            m_ready = true;
+            scheduleRange(atUs + periodUs, periodUs);
+        });
+    }
+
+    void range(uint16_t& mm, uint8_t& status)
+    {
+        double u = uniform();
+        status = 0;
+        if (u < 0.01) {
+            mm = 8190;
+            status = 4;
+        } else if (u < 0.03) {
+            mm = 30 + (uint16_t)(uniform() * 370);
+        } else {
+            double sd = 3 * sqrt(33000.0 / m_budgetUs);
+            double noise = 0;
+            for (int i = 0; i < 4; i++) noise += uniform() - 0.5;
+            mm = (uint16_t)lround(sim::Hardware::instance().waterDistanceMm() + noise * sd * sqrt(3.0));
+        }
+    }
+
+    double uniform()
+    {
+        m_rng = m_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (m_rng >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    uint32_t m_budgetUs;
+    bool m_continuous;
+    bool m_ready;
+    uint16_t m_range;
+    uint8_t m_status;
+    uint64_t m_rng;
+};
+
+#endif
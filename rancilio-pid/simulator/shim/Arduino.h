@@ -0,0 +1,167 @@
+/********************************************************
+  Minimal Arduino/ESP8266 core for the host build.
+  Only what the sketch and the linked libraries use.
+******************************************************/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+
+#include "SimHardware.h"
+#include "binary.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT             0x00
+#define OUTPUT            0x01
+#define INPUT_PULLUP      0x02
+#define INPUT_PULLDOWN_16 0x04
+#define INPUT_PULLDOWN    0x08
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define PROGMEM
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+#define F(s) (s)
+#define os_memcpy memcpy
+
+#define digitalPinToInterrupt(p) (p)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long micros() { return (unsigned long)sim::Hardware::instance().micros(); }
+inline unsigned long millis() { return (unsigned long)(sim::Hardware::instance().micros() / 1000); }
+inline void delay(unsigned long ms) { sim::Hardware::instance().advance((uint64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { sim::Hardware::instance().advance(us); }
+inline void yield() { sim::Hardware::instance().advance(100); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) { sim::Hardware::instance().pinMode(pin, mode); }
+inline int digitalRead(uint8_t pin) { return sim::Hardware::instance().digitalRead(pin); }
+inline void digitalWrite(uint8_t pin, int val) { sim::Hardware::instance().digitalWrite(pin, val); }
+inline int analogRead(uint8_t pin) { return sim::Hardware::instance().analogRead(pin); }
+
+inline void attachInterrupt(uint8_t pin, void (*isr)(), int mode) { sim::Hardware::instance().attachInterrupt(pin, isr, mode); }
+inline void detachInterrupt(uint8_t pin) { sim::Hardware::instance().detachInterrupt(pin); }
+inline void noInterrupts() { sim::Hardware::instance().interruptsEnabled(false); }
+inline void interrupts() { sim::Hardware::instance().interruptsEnabled(true); }
+
+/********************************************************
+  ESP8266 timer1
+******************************************************/
+#define TIM_DIV1   0
+#define TIM_DIV16  1
+#define TIM_DIV256 3
+#define TIM_EDGE   0
+#define TIM_LEVEL  1
+#define TIM_SINGLE 0
+#define TIM_LOOP   1
+
+// control register, only the enable bit is modelled
+#define TCTE 7
+#define T1C  ((uint32_t)sim::Hardware::instance().timer1Enabled() << TCTE)
+
+inline void timer1_isr_init() {}
+inline void timer1_attachInterrupt(void (*isr)()) { sim::Hardware::instance().timer1AttachInterrupt(isr); }
+inline void timer1_write(uint32_t ticks) { sim::Hardware::instance().timer1Write(ticks); }
+inline void timer1_enable(uint8_t divider, uint8_t intType, uint8_t reload) { sim::Hardware::instance().timer1Enable(divider, intType, reload); }
+inline void timer1_disable() { sim::Hardware::instance().timer1Disable(); }
+
+/********************************************************
+  ESP, the cycle counter is the host's (TSC on x86)
+******************************************************/
+class EspClass {
+  public:
+    uint32_t getCycleCount() { return sim::Hardware::instance().hostCycleCount(getCpuFreqMHz()); }
+    uint8_t getCpuFreqMHz() { return 80; }
+};
+
+extern EspClass ESP;
+
+/********************************************************
+  String
+******************************************************/
+class String {
+  public:
+    String() {}
+    String(const char* s) : m_s(s ? s : "") {}
+    String(const std::string& s) : m_s(s) {}
+    String(int v) { format("%d", v); }
+    String(unsigned int v) { format("%u", v); }
+    String(long v) { format("%ld", v); }
+    String(unsigned long v) { format("%lu", v); }
+    String(float v, int decimals = 2) { format("%.*f", decimals, (double)v); }
+    String(double v, int decimals = 2) { format("%.*f", decimals, v); }
+
+    const char* c_str() const { return m_s.c_str(); }
+    unsigned int length() const { return m_s.length(); }
+    bool concat(const String& s) { m_s += s.m_s; return true; }
+    String& operator+=(const String& s) { m_s += s.m_s; return *this; }
+    bool operator==(const char* s) const { return m_s == s; }
+    bool operator!=(const char* s) const { return m_s != s; }
+    friend String operator+(const String& a, const String& b) { return String(a.m_s + b.m_s); }
+
+  private:
+    void format(const char* fmt, ...)
+    {
+        char buf[48];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        m_s = buf;
+    }
+
+    std::string m_s;
+};
+
+/********************************************************
+  Serial, silent unless the simulator runs verbose
+******************************************************/
+class HardwareSerial {
+  public:
+    HardwareSerial() : m_enabled(false) {}
+    void begin(unsigned long) {}
+    void enable(bool enabled) { m_enabled = enabled; }
+
+    void print(const char* v) { write(v); }
+    void print(const String& v) { write(v.c_str()); }
+    void print(char v) { write(std::string(1, v)); }
+    void print(int v) { write(String(v).c_str()); }
+    void print(unsigned int v) { write(String(v).c_str()); }
+    void print(long v) { write(String(v).c_str()); }
+    void print(unsigned long v) { write(String(v).c_str()); }
+    void print(double v) { write(String(v).c_str()); }
+
+    template <typename T> void println(T v) { print(v); write("\n"); }
+    void println() { write("\n"); }
+    void printf(const char* fmt, ...)
+    {
+        if (!m_enabled) return;
+        va_list args;
+        va_start(args, fmt);
+        vprintf(fmt, args);
+        va_end(args);
+    }
+
+  private:
+    void write(const std::string& s) { if (m_enabled) fputs(s.c_str(), stdout); }
+
+    bool m_enabled;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,25 @@
+/********************************************************
+  ArduinoOTA stub for the host build
+******************************************************/
+
+#ifndef ArduinoOTA_h
+#define ArduinoOTA_h
+
+#include <functional>
+
+typedef int ota_error_t;
+
+class ArduinoOTAClass {
+  public:
+    void setHostname(const char*) {}
+    void setPassword(const char*) {}
+    void begin() {}
+    void handle() {}
+    void onStart(std::function<void()>) {}
+    void onEnd(std::function<void()>) {}
+    void onError(std::function<void(ota_error_t)>) {}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
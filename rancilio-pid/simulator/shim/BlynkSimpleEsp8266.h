@@ -0,0 +1,239 @@
+/********************************************************
+  Blynk and ESP8266WiFi stubs for the host build
+
+  The network is "up" only if the simulator enables it
+  (WiFi.simSetOnline()); all traffic is counted, not sent.
+  WiFi.begin() associates after simAssociateMs. Like the
+  real libraries Blynk.connect() and mqtt.connect() block
+  for the lookup of a host name and the TCP handshake, one
+  simRttMs each; with the servers down
+  (simSetServersOnline(false)) the handshake takes the
+  client's connect timeout instead.
+******************************************************/
+
+#ifndef BlynkSimpleEsp8266_h
+#define BlynkSimpleEsp8266_h
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/********************************************************
+  WiFi
+******************************************************/
+#define WL_IDLE_STATUS   0
+#define WL_CONNECTED     3
+#define WL_DISCONNECTED  6
+#define WIFI_STA         1
+
+class IPAddress {
+  public:
+    IPAddress() { m_addr[0] = 127; m_addr[1] = 0; m_addr[2] = 0; m_addr[3] = 1; }
+    IPAddress(uint32_t address)   // network order
+    {
+        for (int i = 0; i < 4; i++) m_addr[i] = (address >> (8 * i)) & 0xff;
+    }
+    uint8_t operator[](int i) const { return m_addr[i & 3]; }
+
+  private:
+    uint8_t m_addr[4];
+};
+
+class ESP8266WiFiClass {
+  public:
+    static const unsigned long simAssociateMs = 2000;
+    static const unsigned long simRttMs = 20;               // DNS answer, TCP handshake
+    static const unsigned long simConnectTimeoutMs = 5000;  // WiFiClient::connect() without an answer
+    static const unsigned long simSynGiveUpMs = 20000;      // lwIP stops resending the SYN
+
+    ESP8266WiFiClass() : m_online(false), m_serversOnline(true), m_begun(false), m_beginMs(0) {}
+
+    int status() const
+    {
+        return (m_online && m_begun && millis() - m_beginMs >= simAssociateMs) ? WL_CONNECTED : WL_DISCONNECTED;
+    }
+    long RSSI() const { return -60; }
+    void begin(const char*, const char*) { m_begun = true; m_beginMs = millis(); }
+    void disconnect(bool = false) { m_begun = false; }
+    void mode(int) {}
+    void persistent(bool) {}
+    void hostname(const char*) {}
+    IPAddress localIP() const { return IPAddress(); }
+
+    // a dropped network needs a new begin()
+    void simSetOnline(bool online) { if (!online) m_begun = false; m_online = online; }
+    bool simOnline() const { return m_online; }
+    void simSetServersOnline(bool online) { m_serversOnline = online; }
+    bool simServersReachable() const { return status() == WL_CONNECTED && m_serversOnline; }
+    // time a blocking client connect takes: lookup of a name, handshake
+    unsigned long simConnectMs(bool byName) const
+    {
+        return (byName ? simRttMs : 0) + (simServersReachable() ? simRttMs : simConnectTimeoutMs);
+    }
+
+  private:
+    bool m_online;
+    bool m_serversOnline;
+    bool m_begun;
+    unsigned long m_beginMs;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+class WiFiClient {
+  public:
+    // bytes/packets an equivalent TCP stream would have carried
+    static unsigned long simBytes;
+    static unsigned long simPackets;
+};
+
+/********************************************************
+  Blynk
+******************************************************/
+#define V0 0
+#define V1 1
+#define V2 2
+#define V3 3
+#define V4 4
+#define V5 5
+#define V6 6
+#define V7 7
+#define V8 8
+#define V9 9
+#define V10 10
+#define V11 11
+#define V12 12
+#define V13 13
+#define V14 14
+#define V15 15
+#define V16 16
+#define V17 17
+#define V18 18
+#define V19 19
+#define V20 20
+#define V21 21
+#define V22 22
+#define V23 23
+#define V24 24
+#define V25 25
+#define V26 26
+#define V27 27
+#define V28 28
+#define V29 29
+#define V30 30
+#define V31 31
+#define V32 32
+#define V33 33
+#define V34 34
+#define V35 35
+#define V36 36
+#define V37 37
+#define V38 38
+#define V39 39
+#define V40 40
+#define V41 41
+#define V42 42
+#define V43 43
+#define V44 44
+#define V45 45
+#define V46 46
+#define V47 47
+#define V48 48
+#define V49 49
+#define V50 50
+#define V51 51
+#define V52 52
+#define V53 53
+#define V54 54
+#define V55 55
+#define V56 56
+#define V57 57
+#define V58 58
+#define V59 59
+#define V60 60
+#define V61 61
+#define V62 62
+#define V63 63
+
+class BlynkParam {
+  public:
+    explicit BlynkParam(const char* value) : m_value(value) {}
+    int asInt() const { return atoi(m_value); }
+    double asDouble() const { return atof(m_value); }
+    float asFloat() const { return (float)atof(m_value); }
+    const char* asStr() const { return m_value; }
+
+  private:
+    const char* m_value;
+};
+
+#define BLYNK_WRITE(pin) void BlynkWidgetWrite_##pin(const BlynkParam& param)
+#define BLYNK_CONNECTED() void BlynkOnConnected()
+void BlynkOnConnected();   // the sketch's BLYNK_CONNECTED()
+
+class BlynkStub {
+  public:
+    BlynkStub() : m_connected(false), m_byName(true), m_writes(0), m_bytes(0) {}
+
+    void config(const char*, const char*, int) { m_byName = true; }
+    void config(const char*, IPAddress, int) { m_byName = false; }
+    // the login is done by run(), not counted; without a server
+    // run() keeps retrying until the timeout. Like the login,
+    // a connect calls BLYNK_CONNECTED()
+    bool connect(unsigned long timeout = 0)
+    {
+        m_connected = false;
+        if (WiFi.status() != WL_CONNECTED) return false;
+        m_connected = WiFi.simServersReachable();
+        unsigned long ms = WiFi.simConnectMs(m_byName);
+        delay(!m_connected && timeout > ms ? timeout : ms);
+        if (m_connected) BlynkOnConnected();
+        return m_connected;
+    }
+    // a connection lost with the server stays lost
+    bool connected()
+    {
+        if (!WiFi.simServersReachable()) m_connected = false;
+        return m_connected;
+    }
+    void run() {}
+    void syncAll() {}
+    template <typename... Pins> void syncVirtual(Pins...) {}
+
+    template <typename... Values> void virtualWrite(int pin, Values... values)
+    {
+        // "vw\0<pin>\0<value>..." plus the 5 byte Blynk header
+        unsigned long len = 5 + 3 + String(pin).length() + 1;
+        len += valueLength(values...);
+        m_writes++;
+        m_bytes += len;
+        WiFiClient::simBytes += len;
+        WiFiClient::simPackets++;
+    }
+
+    unsigned long simWrites() const { return m_writes; }
+    unsigned long simBytes() const { return m_bytes; }
+
+  private:
+    static unsigned long valueLength() { return 0; }
+    template <typename T, typename... Rest> static unsigned long valueLength(T v, Rest... rest)
+    {
+        return String(v).length() + 1 + valueLength(rest...);
+    }
+    template <typename... Rest> static unsigned long valueLength(const char* v, Rest... rest)
+    {
+        return strlen(v) + 1 + valueLength(rest...);
+    }
+    template <typename... Rest> static unsigned long valueLength(const String& v, Rest... rest)
+    {
+        return v.length() + 1 + valueLength(rest...);
+    }
+
+    bool m_connected;
+    bool m_byName;   // config() with a host name
+    unsigned long m_writes;
+    unsigned long m_bytes;
+};
+
+extern BlynkStub Blynk;
+
+#endif
@@ -0,0 +1,132 @@
+/********************************************************
+  DallasTemperature (DS18B20) stub for the host build.
+
+  simSetDevices() puts up to maxDevices sensors on the bus,
+  sensor #i reads temperature channel i. A conversion
+  latches all of them after the datasheet conversion time
+  of the configured resolution; with waitForConversion the
+  request blocks (advances simulated time) just like the
+  real library. Bus transactions cost their OneWire time:
+  reset 1 ms, 70 us per bit.
+******************************************************/
+
+#ifndef DallasTemperature_h
+#define DallasTemperature_h
+
+#include "Arduino.h"
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+  public:
+    static const uint8_t maxDevices = 4;
+
+    explicit DallasTemperature(OneWire* wire)
+        : m_wire(wire), m_resolution(12), m_wait(true), m_readyUs(0)
+    {
+        for (int i = 0; i < maxDevices; i++) m_latched[i] = DEVICE_DISCONNECTED_C;
+    }
+
+    static uint8_t& simDevices()
+    {
+        static uint8_t devices = 1;
+        return devices;
+    }
+    static void simSetDevices(uint8_t n) { simDevices() = n > maxDevices ? maxDevices : n; }
+
+    void begin() {}
+    uint8_t getDeviceCount() { return simDevices(); }
+
+    bool getAddress(uint8_t* address, uint8_t index)
+    {
+        if (index >= simDevices()) return false;
+        static const uint8_t rom[8] = { 0x28, 0x53, 0x49, 0x4d, 0x00, 0x00, 0x00, 0x5a };
+        memcpy(address, rom, 8);
+        address[6] = index;
+        return true;
+    }
+
+    void setResolution(uint8_t resolution) { m_resolution = resolution; }
+    bool setResolution(const uint8_t*, uint8_t resolution, bool = false) { m_resolution = resolution; return true; }
+    uint8_t getResolution() { return m_resolution; }
+    void setWaitForConversion(bool wait) { m_wait = wait; }
+    bool getWaitForConversion() { return m_wait; }
+
+    int16_t millisToWaitForConversion(uint8_t resolution)
+    {
+        switch (resolution) {
+            case 9: return 94;
+            case 10: return 188;
+            case 11: return 375;
+            default: return 750;
+        }
+    }
+
+    // skip ROM: all sensors convert at once
+    void requestTemperatures()
+    {
+        busTime(2);
+        startConversion();
+    }
+
+    bool requestTemperaturesByAddress(const uint8_t*)
+    {
+        busTime(10);
+        startConversion();
+        return true;
+    }
+    bool requestTemperaturesByIndex(uint8_t) { return requestTemperaturesByAddress(NULL); }
+
+    bool isConversionComplete()
+    {
+        delayMicroseconds(bitUs);
+        return sim::Hardware::instance().micros() >= m_readyUs;
+    }
+
+    // match ROM, read the scratchpad
+    float getTempC(const uint8_t* address)
+    {
+        busTime(19);
+        uint8_t index = address[6];
+        return index < simDevices() ? m_latched[index] : DEVICE_DISCONNECTED_C;
+    }
+    float getTempCByIndex(uint8_t index)
+    {
+        DeviceAddress address;
+        if (!getAddress(address, index)) return DEVICE_DISCONNECTED_C;
+        return getTempC(address);
+    }
+
+  private:
+    static const unsigned int resetUs = 1000;
+    static const unsigned int bitUs = 70;
+
+    static void busTime(unsigned int bytes) { delayMicroseconds(resetUs + bytes * 8 * bitUs); }
+
+    void startConversion()
+    {
+        sim::Hardware& hw = sim::Hardware::instance();
+        m_readyUs = hw.micros() + (uint64_t)millisToWaitForConversion(m_resolution) * 1000;
+        hw.schedule(m_readyUs, [this]() { latch(); });
+        if (m_wait) delay(millisToWaitForConversion(m_resolution));
+    }
+
+    void latch()
+    {
+        float step = 0.0625f * (1 << (12 - m_resolution));
+        for (int i = 0; i < simDevices(); i++) {
+            m_latched[i] = floorf((float)sim::Hardware::instance().temperature(i) / step) * step;
+        }
+    }
+
+    OneWire* m_wire;
+    uint8_t m_resolution;
+    bool m_wait;
+    uint64_t m_readyUs;
+    float m_latched[maxDevices];
+};
+
+#endif
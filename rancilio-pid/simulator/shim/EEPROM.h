@@ -0,0 +1,46 @@
+/********************************************************
+  EEPROM emulation of the ESP8266 core (RAM backed)
+******************************************************/
+
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass {
+  public:
+    static const size_t maxSize = 4096;
+
+    EEPROMClass() : m_size(0), m_commits(0) { memset(m_data, 0xFF, sizeof(m_data)); }
+
+    void begin(size_t size) { m_size = size <= maxSize ? size : maxSize; }
+    uint8_t read(int address) const { return valid(address, 1) ? m_data[address] : 0; }
+    void write(int address, uint8_t value) { if (valid(address, 1)) m_data[address] = value; }
+    bool commit() { m_commits++; return m_size > 0; }
+    unsigned long commits() const { return m_commits; }
+
+    template <typename T> T& get(int address, T& t)
+    {
+        if (valid(address, sizeof(T))) memcpy(&t, m_data + address, sizeof(T));
+        return t;
+    }
+
+    template <typename T> const T& put(int address, const T& t)
+    {
+        if (valid(address, sizeof(T))) memcpy(m_data + address, &t, sizeof(T));
+        return t;
+    }
+
+  private:
+    bool valid(int address, size_t len) const { return address >= 0 && address + len <= m_size; }
+
+    uint8_t m_data[maxSize];
+    size_t m_size;
+    unsigned long m_commits;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
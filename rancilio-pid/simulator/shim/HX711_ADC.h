@@ -0,0 +1,162 @@
+/********************************************************
+  HX711_ADC stub for the host build
+
+  After begin() the HX711 converts simSps() times a
+  second (10, or 80 with its RATE pin high); a finished
+  conversion pulls DOUT low, which raises a DOUT interrupt
+  if one is attached, and stays there until update()
+  reads it out; a newer conversion replaces an unread one
+  like on the chip. The conversion is the scale load of
+  the simulation (grams * calFactor) plus noise, more of
+  it at 80 SPS (datasheet 90 instead of 50 nV rms).
+  getData() averages the samples in use without the
+  highest and lowest one, like the library.
+******************************************************/
+
+#ifndef HX711_ADC_h
+#define HX711_ADC_h
+
+#include "Arduino.h"
+
+#define SAMPLES 16
+#define IGN_HIGH_SAMPLE 1
+#define IGN_LOW_SAMPLE 1
+#define DATA_SET SAMPLES + IGN_HIGH_SAMPLE + IGN_LOW_SAMPLE
+
+class HX711_ADC {
+  public:
+    HX711_ADC(uint8_t dout, uint8_t sck)
+        : m_dout(dout), m_sck(sck), m_started(false), m_ready(false), m_raw(0), m_calFactor(1),
+          m_tareOffset(0), m_readIndex(0), m_samplesInUse(SAMPLES), m_lastSmoothed(0), m_sampleCount(0),
+          m_sampleTime(0), m_noise(12345)
+    {
+        for (int i = 0; i < DATA_SET; i++) m_set[i] = 0;
+    }
+
+    static unsigned int& simSps()
+    {
+        static unsigned int sps = 10;
+        return sps;
+    }
+
+    void begin()
+    {
+        pinMode(m_sck, OUTPUT);
+        pinMode(m_dout, INPUT);
+        sim::Hardware::instance().setDigitalInput(m_dout, HIGH);
+        if (!m_started) {
+            m_started = true;
+            scheduleConversion(sim::Hardware::instance().micros() + periodUs());
+        }
+    }
+
+    void start(unsigned long t, bool dotare = true)
+    {
+        unsigned long end = millis() + t + 400;
+        while (millis() < end) {
+            update();
+            yield();
+        }
+        if (dotare) tare();
+    }
+
+    void tare()
+    {
+        for (int i = 0; i < DATA_SET + 1;) {
+            if (update()) i++;
+            yield();
+        }
+        m_tareOffset = smoothedData();
+    }
+
+    bool getTareTimeoutFlag() { return false; }
+    void setCalFactor(float cal) { m_calFactor = cal; }
+    float getCalFactor() { return m_calFactor; }
+
+    uint8_t update()
+    {
+        if (!m_ready) return 0;
+        m_ready = false;
+        sim::Hardware::instance().setDigitalInput(m_dout, HIGH);
+        m_readIndex = m_readIndex + 1 < m_samplesInUse + IGN_HIGH_SAMPLE + IGN_LOW_SAMPLE ? m_readIndex + 1 : 0;
+        m_set[m_readIndex] = m_raw;
+        m_sampleCount++;
+        m_sampleTime = micros();
+        return 1;
+    }
+
+    float getData()
+    {
+        m_lastSmoothed = smoothedData();
+        return (m_lastSmoothed - m_tareOffset) / m_calFactor;
+    }
+
+    void setSamplesInUse(int samples)
+    {
+        int inUse = 1;
+        while (inUse * 2 <= samples && inUse * 2 <= SAMPLES) inUse *= 2;
+        if (inUse == m_samplesInUse) return;
+        m_samplesInUse = inUse;
+        for (int i = 0; i < m_samplesInUse + IGN_HIGH_SAMPLE + IGN_LOW_SAMPLE; i++) m_set[i] = m_lastSmoothed;
+        m_readIndex = 0;
+    }
+    int getSamplesInUse() { return m_samplesInUse; }
+
+    unsigned long getSampleCount() { return m_sampleCount; }
+    unsigned long getSampleTime() { return m_sampleTime; }
+
+  private:
+    static const long zeroRaw = 84000;   // conversion of the empty scale
+
+    uint64_t periodUs() const { return 1000000 / simSps(); }
+
+    void scheduleConversion(uint64_t atUs)
+    {
+        sim::Hardware::instance().schedule(atUs, [this, atUs]() {
+            m_raw = zeroRaw + (sim::Hardware::instance().scaleGrams() + noise()) * m_calFactor;
+            m_ready = true;
+            sim::Hardware::instance().setDigitalInput(m_dout, LOW);
+            scheduleConversion(atUs + periodUs());
+        });
+    }
+
+    double smoothedData() const
+    {
+        int n = m_samplesInUse + IGN_HIGH_SAMPLE + IGN_LOW_SAMPLE;
+        double sum = 0, low = m_set[0], high = m_set[0];
+        for (int i = 0; i < n; i++) {
+            sum += m_set[i];
+            if (m_set[i] < low) low = m_set[i];
+            if (m_set[i] > high) high = m_set[i];
+        }
+        return (sum - low - high) / m_samplesInUse;
+    }
+
+    // roughly normal, sum of 4 uniforms
+    double noise()
+    {
+        double sd = simSps() >= 80 ? 0.18 : 0.1;
+        double sum = 0;
+        for (int i = 0; i < 4; i++) {
+            m_noise = m_noise * 6364136223846793005ULL + 1442695040888963407ULL;
+            sum += (m_noise >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+        }
+        return sum * sd * sqrt(3.0);
+    }
+
+    uint8_t m_dout, m_sck;
+    bool m_started;
+    bool m_ready;
+    double m_raw;
+    float m_calFactor;
+    double m_tareOffset;
+    int m_readIndex;
+    int m_samplesInUse;
+    double m_lastSmoothed;
+    double m_set[DATA_SET];
+    unsigned long m_sampleCount;
+    unsigned long m_sampleTime;
+    uint64_t m_noise;
+};
+
+#endif
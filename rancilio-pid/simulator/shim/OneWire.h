@@ -0,0 +1,19 @@
+/********************************************************
+  OneWire stub for the host build
+******************************************************/
+
+#ifndef OneWire_h
+#define OneWire_h
+
+#include "Arduino.h"
+
+class OneWire {
+  public:
+    explicit OneWire(uint8_t pin) : m_pin(pin) {}
+    uint8_t pin() const { return m_pin; }
+
+  private:
+    uint8_t m_pin;
+};
+
+#endif
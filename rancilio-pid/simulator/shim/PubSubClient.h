@@ -0,0 +1,72 @@
+/********************************************************
+  PubSubClient stub for the host build, counts traffic.
+  Like the library, publish() fails for a packet that
+  does not fit the buffer (256 bytes, setBufferSize()),
+  and connect() blocks for the TCP connect
+  (WiFi.simConnectMs()) and the CONNACK round trip.
+******************************************************/
+
+#ifndef PubSubClient_h
+#define PubSubClient_h
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp8266.h>
+#include <functional>
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient {
+  public:
+    explicit PubSubClient(WiFiClient&) : m_connected(false), m_byName(true), m_socketTimeout(15), m_bufferSize(256), m_publishes(0), m_bytes(0) {}
+
+    PubSubClient& setServer(const char*, uint16_t) { m_byName = true; return *this; }
+    PubSubClient& setServer(IPAddress, uint16_t) { m_byName = false; return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { return *this; }
+    PubSubClient& setSocketTimeout(uint16_t timeout) { m_socketTimeout = timeout; return *this; }
+    boolean setBufferSize(uint16_t size) { m_bufferSize = size; return size > 0; }
+    uint16_t getBufferSize() { return m_bufferSize; }
+
+    bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*)
+    {
+        m_connected = false;
+        if (WiFi.status() != WL_CONNECTED) return false;
+        m_connected = WiFi.simServersReachable();
+        delay(WiFi.simConnectMs(m_byName) + (m_connected ? WiFi.simRttMs : 0));
+        return m_connected;
+    }
+    // a connection lost with the broker stays lost
+    bool connected()
+    {
+        if (!WiFi.simServersReachable()) m_connected = false;
+        return m_connected;
+    }
+    bool loop() { return connected(); }
+    bool subscribe(const char*) { return connected(); }
+
+    bool publish(const char* topic, const char* payload, bool retained = false)
+    {
+        (void)retained;
+        if (!connected()) return false;
+        // fixed header (2) + topic length (2) + topic + payload
+        unsigned long len = 4 + strlen(topic) + strlen(payload);
+        if (len + 3 > m_bufferSize) return false;   // library reserves 5 header bytes
+        m_publishes++;
+        m_bytes += len;
+        WiFiClient::simBytes += len;
+        WiFiClient::simPackets++;
+        return true;
+    }
+
+    unsigned long simPublishes() const { return m_publishes; }
+    unsigned long simBytes() const { return m_bytes; }
+
+  private:
+    bool m_connected;
+    bool m_byName;   // setServer() with a host name
+    uint16_t m_socketTimeout;
+    uint16_t m_bufferSize;
+    unsigned long m_publishes;
+    unsigned long m_bytes;
+};
+
+#endif
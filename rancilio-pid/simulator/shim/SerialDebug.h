@@ -0,0 +1,29 @@
+/********************************************************
+  SerialDebug stub for the host build.
+  Messages go to stdout when the simulator runs verbose;
+  registered commands can be invoked by the simulator.
+******************************************************/
+
+#ifndef SerialDebug_h
+#define SerialDebug_h
+
+#include "Arduino.h"
+
+namespace sim {
+void debugPrintf(char level, const char* fmt, ...);
+int debugAddFunction(const char* name, void (*function)());
+bool debugRunCommand(const char* name);
+}
+
+#define debugA(...) sim::debugPrintf('A', __VA_ARGS__)
+#define debugE(...) sim::debugPrintf('E', __VA_ARGS__)
+#define debugW(...) sim::debugPrintf('W', __VA_ARGS__)
+#define debugI(...) sim::debugPrintf('I', __VA_ARGS__)
+#define debugD(...) sim::debugPrintf('D', __VA_ARGS__)
+#define debugV(...) sim::debugPrintf('V', __VA_ARGS__)
+
+inline int debugAddFunctionVoid(const char* name, void (*function)()) { return sim::debugAddFunction(name, function); }
+inline void debugSetLastFunctionDescription(const char*) {}
+inline void debugHandle() {}
+
+#endif
@@ -0,0 +1,86 @@
+/********************************************************
+  TSIC bit-banging reader stub for the host build
+
+  The sensor sends a frame every framePeriodUs, each takes
+  frameUs to read. getTemperature() blocks until the next
+  frame is through, like the real bit-banger.
+  pollTemperature() has the cost of the real one: two
+  blocking frames to synchronise, then it only blocks if
+  the next frame starts within TSIC_SYNC_WINDOW_US.
+******************************************************/
+
+#ifndef TSIC_h
+#define TSIC_h
+
+#include "Arduino.h"
+
+#define TSIC_20x    0
+#define TSIC_30x    0
+#define TSIC_50x    1
+
+#define NO_VCC_PIN 255
+
+#define TSIC_SYNC_WINDOW_US 1000
+
+class TSIC {
+  public:
+    static const uint64_t framePeriodUs = 100000;
+    static const uint64_t framePhaseUs = 37000;
+    static const uint64_t frameUs = 2700;
+
+    explicit TSIC(uint8_t signal_pin, uint8_t vcc_pin = NO_VCC_PIN, uint8_t sens_type = TSIC_30x)
+        : m_synced(false)
+    {
+        (void)signal_pin;
+        (void)vcc_pin;
+        (void)sens_type;
+    }
+
+    uint8_t getTemperature(uint16_t* temp_value16)
+    {
+        delayMicroseconds((unsigned int)(untilFrame() + frameUs));
+        return frame(temp_value16);
+    }
+
+    uint8_t pollTemperature(uint16_t* temp_value16)
+    {
+        if (!m_synced) {
+            getTemperature(temp_value16);
+            m_synced = true;
+        } else if (untilFrame() > TSIC_SYNC_WINDOW_US) {
+            return 0;
+        }
+        return getTemperature(temp_value16);
+    }
+
+    uint32_t framePeriod() { return m_synced ? framePeriodUs : 0; }
+
+    float calc_Celsius(uint16_t* temperature16)
+    {
+        int16_t temp_value16 = ((*temperature16 * 250L) >> 8) - 500;
+        return temp_value16 / 10 + (float)(temp_value16 % 10) / 10;
+    }
+
+  private:
+    static uint64_t untilFrame()
+    {
+        uint64_t now = sim::Hardware::instance().micros();
+        uint64_t since = (now + framePeriodUs - framePhaseUs) % framePeriodUs;
+        return since == 0 ? 0 : framePeriodUs - since;
+    }
+
+    uint8_t frame(uint16_t* temp_value16)
+    {
+        // inverse of calc_Celsius() for 20x/30x sensors (LT=-50, HT=150)
+        double t = sim::Hardware::instance().temperature(0);
+        long raw = lround((t * 10 + 500) * 256 / 250);
+        if (raw < 0) raw = 0;
+        if (raw > 2047) raw = 2047;
+        *temp_value16 = (uint16_t)raw;
+        return 1;
+    }
+
+    bool m_synced;
+};
+
+#endif
@@ -0,0 +1,13 @@
+/********************************************************
+  U8g2 placeholder, the host build runs with DISPLAY 0
+******************************************************/
+
+#ifndef U8G2LIB_HH
+#define U8G2LIB_HH
+
+#define U8G2_R0 0
+#define U8G2_R1 1
+#define U8G2_R2 2
+#define U8G2_R3 3
+
+#endif
@@ -0,0 +1,88 @@
+/********************************************************
+  ZACwire (TSic 206/306/506) stub for the host build.
+  Returns the simulated sensor temperature with the
+  0.1 °C resolution of the real decoder. After begin()
+  (or the first getTemp()) a frame is captured every
+  framePeriodUs into the same 8 slot ring as the real
+  ISR, getSample() drains it.
+******************************************************/
+
+#ifndef ZACwire_h
+#define ZACwire_h
+
+#include "Arduino.h"
+
+template <uint8_t pin>
+class ZACwire {
+  public:
+    static const uint64_t framePeriodUs = 100000;   // TSic 306: 10 Hz
+    static const uint8_t sampleSlots = 8;
+
+    ZACwire(int Sensortype = 306, byte defaultBitWindow = 125, bool core = 1)
+        : m_started(false), m_head(0), m_tail(0), m_lost(0)
+    {
+        (void)Sensortype;
+        (void)defaultBitWindow;
+        (void)core;
+    }
+
+    bool begin()
+    {
+        if (!m_started) {
+            m_started = true;
+            scheduleFrame(sim::Hardware::instance().micros() + framePeriodUs);
+        }
+        return true;
+    }
+
+    float getTemp()
+    {
+        if (!m_started) {
+            begin();
+            delay(110);
+        }
+        return quantize(sim::Hardware::instance().temperature(0));
+    }
+
+    bool getSample(float& celsius, unsigned long& capturedUs)
+    {
+        if (m_tail == m_head) return false;
+        celsius = m_samples[m_tail].celsius;
+        capturedUs = m_samples[m_tail].us;
+        m_tail = (m_tail + 1) & (sampleSlots - 1);
+        return true;
+    }
+
+    byte samplesLost() { return m_lost; }
+
+    void end() {}
+
+  private:
+    struct Sample {
+        float celsius;
+        unsigned long us;
+    };
+
+    static float quantize(double celsius) { return floorf(celsius * 10 + 0.5f) / 10; }
+
+    void scheduleFrame(uint64_t atUs)
+    {
+        sim::Hardware::instance().schedule(atUs, [this, atUs]() {
+            uint8_t next = (m_head + 1) & (sampleSlots - 1);
+            if (next == m_tail) {
+                m_lost++;
+            } else {
+                m_samples[m_head].celsius = quantize(sim::Hardware::instance().temperature(0));
+                m_samples[m_head].us = (unsigned long)atUs;
+                m_head = next;
+            }
+            scheduleFrame(atUs + framePeriodUs);
+        });
+    }
+
+    bool m_started;
+    Sample m_samples[sampleSlots];
+    uint8_t m_head, m_tail, m_lost;
+};
+
+#endif
@@ -0,0 +1,74 @@
+/********************************************************
+  Global objects of the host Arduino core
+******************************************************/
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <ArduinoOTA.h>
+#include <BlynkSimpleEsp8266.h>
+#include <SerialDebug.h>
+
+#include <map>
+#include <string>
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+ArduinoOTAClass ArduinoOTA;
+ESP8266WiFiClass WiFi;
+BlynkStub Blynk;
+
+unsigned long WiFiClient::simBytes = 0;
+unsigned long WiFiClient::simPackets = 0;
+
+namespace sim {
+
+namespace {
+bool s_logEnabled = false;
+
+std::map<std::string, void (*)()>& debugFunctions()
+{
+    static std::map<std::string, void (*)()> functions;
+    return functions;
+}
+}
+
+void setLogEnabled(bool enabled)
+{
+    s_logEnabled = enabled;
+    Serial.enable(enabled);
+}
+
+bool logEnabled()
+{
+    return s_logEnabled;
+}
+
+void debugPrintf(char level, const char* fmt, ...)
+{
+    // "A" (always) output belongs to commands run on request
+    if (level != 'A' && !logEnabled()) return;
+
+    va_list args;
+    va_start(args, fmt);
+    printf("(%c) ", level);
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+}
+
+int debugAddFunction(const char* name, void (*function)())
+{
+    debugFunctions()[name] = function;
+    return (int)debugFunctions().size() - 1;
+}
+
+bool debugRunCommand(const char* name)
+{
+    std::map<std::string, void (*)()>::iterator it = debugFunctions().find(name);
+    if (it == debugFunctions().end()) return false;
+    it->second();
+    return true;
+}
+
+}
@@ -0,0 +1,37 @@
+/********************************************************
+  lwIP DNS for the host build: a dotted address resolves
+  at once, a name after WiFi.simRttMs while the WiFi is
+  up (the resolver is the router, not the servers).
+******************************************************/
+
+#ifndef lwip_dns_h
+#define lwip_dns_h
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp8266.h>
+#include "ip_addr.h"
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+inline err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg)
+{
+    unsigned a, b, c, d;
+    char end;
+    if (sscanf(hostname, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) == 4)
+    {
+        addr->addr = a | b << 8 | c << 16 | d << 24;
+        return ERR_OK;
+    }
+    if (WiFi.status() != WL_CONNECTED) return ERR_VAL;
+
+    std::string name(hostname);
+    sim::Hardware& hw = sim::Hardware::instance();
+    hw.schedule(hw.micros() + ESP8266WiFiClass::simRttMs * 1000ULL, [name, found, callback_arg]() {
+        ip_addr_t resolved;
+        resolved.addr = WiFi.status() == WL_CONNECTED ? 0x0a00000a : 0;   // 10.0.0.10
+        found(name.c_str(), resolved.addr ? &resolved : NULL, callback_arg);
+    });
+    return ERR_INPROGRESS;
+}
+
+#endif
@@ -0,0 +1,30 @@
+/********************************************************
+  lwIP addresses and error codes for the host build
+  (IPv4 only, like the default ESP8266 lwIP2 build)
+******************************************************/
+
+#ifndef lwip_ip_addr_h
+#define lwip_ip_addr_h
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+typedef uint16_t u16_t;
+
+#define ERR_OK          0
+#define ERR_MEM        -1
+#define ERR_INPROGRESS -5
+#define ERR_VAL        -6
+#define ERR_ABRT      -13
+#define ERR_RST       -14
+
+struct ip4_addr {
+    uint32_t addr;   // network order
+};
+typedef struct ip4_addr ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+
+#define ip_2_ip4(ipaddr) (ipaddr)
+#define ip_addr_set_ip4_u32(ipaddr, val) ((ipaddr)->addr = (val))
+
+#endif
@@ -0,0 +1,80 @@
+/********************************************************
+  lwIP raw TCP API for the host build, only connect and
+  abort. The handshake takes WiFi.simRttMs when the
+  servers are reachable, otherwise lwIP gives up after
+  WiFi.simSynGiveUpMs. Callbacks run from hw.schedule(),
+  like the real ones between two loop passes.
+******************************************************/
+
+#ifndef lwip_tcp_h
+#define lwip_tcp_h
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp8266.h>
+#include "ip_addr.h"
+
+struct tcp_pcb;
+typedef void (*tcp_err_fn)(void* arg, err_t err);
+typedef err_t (*tcp_connected_fn)(void* arg, struct tcp_pcb* tpcb, err_t err);
+
+struct tcp_pcb {
+    void* arg;
+    tcp_err_fn errf;
+    tcp_connected_fn connected;
+    bool pending;   // handshake event scheduled
+    bool aborted;
+};
+
+inline struct tcp_pcb* tcp_new()
+{
+    struct tcp_pcb* pcb = new tcp_pcb();
+    pcb->arg = NULL;
+    pcb->errf = NULL;
+    pcb->connected = NULL;
+    pcb->pending = false;
+    pcb->aborted = false;
+    return pcb;
+}
+
+inline void tcp_arg(struct tcp_pcb* pcb, void* arg) { pcb->arg = arg; }
+inline void tcp_err(struct tcp_pcb* pcb, tcp_err_fn errf) { pcb->errf = errf; }
+
+// frees the pcb once no event refers to it, calls the error callback
+inline void tcp_abort(struct tcp_pcb* pcb)
+{
+    tcp_err_fn errf = pcb->errf;
+    void* arg = pcb->arg;
+    pcb->aborted = true;
+    if (!pcb->pending) delete pcb;
+    if (errf) errf(arg, ERR_ABRT);
+}
+
+inline err_t tcp_connect(struct tcp_pcb* pcb, const ip_addr_t*, u16_t, tcp_connected_fn connected)
+{
+    if (WiFi.status() != WL_CONNECTED) return ERR_RST;
+    bool reachable = WiFi.simServersReachable();
+    pcb->connected = connected;
+    pcb->pending = true;
+    sim::Hardware& hw = sim::Hardware::instance();
+    unsigned long ms = reachable ? ESP8266WiFiClass::simRttMs : ESP8266WiFiClass::simSynGiveUpMs;
+    hw.schedule(hw.micros() + ms * 1000ULL, [pcb, reachable]() {
+        pcb->pending = false;
+        if (pcb->aborted)
+        {
+            delete pcb;
+            return;
+        }
+        if (reachable)
+        {
+            pcb->connected(pcb->arg, pcb, ERR_OK);
+            return;
+        }
+        tcp_err_fn errf = pcb->errf;
+        void* arg = pcb->arg;
+        delete pcb;
+        if (errf) errf(arg, ERR_ABRT);
+    });
+    return ERR_OK;
+}
+
+#endif
@@ -0,0 +1,666 @@
+/********************************************************
+  Host simulator for rancilio-pid
+
+  Runs the sketch's setup()/loop() against simulated
+  hardware and a boiler model in simulated time, pulls
+  shots on a fixed schedule and reports control quality
+  (heat-up, ripple, dip and recovery per shot) and the
+  host CPU cost of loop() and the timer ISR.
+
+  Results only depend on the options, never on the host:
+  the same build and options give the same trace.
+******************************************************/
+
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <BlynkSimpleEsp8266.h>
+#include <DallasTemperature.h>
+#include <EEPROM.h>
+#include <HX711_ADC.h>
+#include <SerialDebug.h>
+
+#include "userConfig.h"
+#include "BoilerModel.h"
+#include "SimHardware.h"
+#include "SketchProbe.h"
+
+namespace {
+
+struct Options {
+    Options()
+        : durationS(4 * 3600), loopUs(1000), firstShotS(1800), shotIntervalS(900),
+          shots(8), shotS(30), shotFlowMlS(2.0), settleS(300), recoveryWindowS(240),
+          band(0.5), autotuneAtS(-1), online(false), outageS(-1), outageLengthS(0),
+          serverOutageS(-1), serverOutageLengthS(0), ds18b20(1), scaleSps(10), pumpRippleBar(0.8), pvsAc(false), steamS(-1), steamLengthS(0),
+          switchAdc(1024), switchNoise(0),
+          csvIntervalMs(1000) {}
+
+    double durationS;       // simulated time
+    unsigned long loopUs;   // simulated duration of one loop() pass
+    double firstShotS;      // first shot after power on
+    double shotIntervalS;   // time between shot starts
+    int shots;              // number of shots, 0 = none
+    double shotS;           // brew switch / pump on time
+    double shotFlowMlS;     // water drawn from the boiler while the pump runs
+    double settleS;         // time after heat-up that is not counted as steady state
+    double recoveryWindowS; // time after a shot that is not counted as steady state
+    double band;            // +/- band around setpoint for heat-up and recovery
+    double autotuneAtS;     // start the autotune at this time, < 0 = never
+    bool online;            // simulate WiFi, Blynk and MQTT as reachable
+    double outageS;         // WiFi drops at this time, < 0 = never
+    double outageLengthS;
+    double serverOutageS;   // Blynk and MQTT server unreachable at this time, < 0 = never
+    double serverOutageLengthS;
+    int ds18b20;            // DS18B20 on the bus (TEMPSENSOR 1), #1 is on the group head
+    unsigned int scaleSps;  // HX711 samples per second, 10 or 80 (RATE pin high)
+    double pumpRippleBar;   // pressure pulsation of the vibratory pump, amplitude
+    bool pvsAc;             // voltage sensor passes the half waves of the pump voltage
+    double steamS;          // steam valve opened at this time (QuickMill pump pulses), < 0 = never
+    double steamLengthS;
+    int switchAdc;          // analog brew switch (PINBREWSWITCH 0): reading when closed
+    double switchNoise;     // and its noise, standard deviation in LSB
+    std::string csvPath;
+    unsigned long csvIntervalMs;
+    std::vector<std::string> commands;
+    BoilerParams boiler;
+};
+
+struct Shot {
+    double startS;
+    double endS;
+    double minBoilerC;
+    double minInput;
+    double lastOutOfBandS;
+    double detectedS;       // machine state 30 (brew) first seen, < 0 = not detected
+    double startGrams;      // cup on the scale at the start
+    double crossS;          // cup reached WEIGHTSETPOINT - scaleDelayValue, < 0 = not yet
+    double pumpOffS;        // pump stopped after crossS, < 0 = not yet
+    double finalGrams;      // in the cup once it stopped dripping
+    double switchOnS;       // sketch saw the brew switch on, < 0 = not yet
+    double switchOffS;      // and off again
+};
+
+/********************************************************
+  Statistics over the run
+******************************************************/
+struct RunningStats {
+    RunningStats() : n(0), sum(0), sumSq(0), min(1e9), max(-1e9) {}
+
+    void add(double v)
+    {
+        n++;
+        sum += v;
+        sumSq += v * v;
+        if (v < min) min = v;
+        if (v > max) max = v;
+    }
+    double mean() const { return n ? sum / n : 0; }
+    double rms() const { return n ? sqrt(sumSq / n) : 0; }
+
+    unsigned long n;
+    double sum, sumSq, min, max;
+};
+
+/********************************************************
+  Rig: everything outside the ESP, driven by the pins
+******************************************************/
+class Rig : public sim::Plant {
+  public:
+    Rig(const Options& options, BoilerModel& boiler)
+        : m_options(options), m_boiler(boiler), m_groupC(options.boiler.startC), m_cupFlow(0), m_cupGrams(0),
+          m_pressureBar(0), m_adcRng(options.boiler.seed + 1), m_adcNoise(0, 2), m_tankMl(kTankMl),
+          m_pumpVoltage(false)
+    {
+        if (BREWDETECTION == 3 && options.pvsAc) scheduleHalfWave(0);
+        for (int i = 0; i < options.shots; i++) {
+            Shot shot;
+            shot.startS = options.firstShotS + i * options.shotIntervalS;
+            shot.endS = shot.startS + options.shotS;
+            shot.minBoilerC = 1e9;
+            shot.minInput = 1e9;
+            shot.lastOutOfBandS = shot.startS;
+            shot.detectedS = -1;
+            shot.startGrams = 0;
+            shot.crossS = -1;
+            shot.pumpOffS = -1;
+            shot.finalGrams = 0;
+            shot.switchOnS = -1;
+            shot.switchOffS = -1;
+            if (shot.startS < options.durationS) m_shots.push_back(shot);
+        }
+    }
+
+    void step(uint64_t nowUs, double dtS)
+    {
+        sim::Hardware& hw = sim::Hardware::instance();
+        double t = nowUs / 1e6;
+
+        bool shotActive = false;
+        Shot* shot = NULL;
+        for (size_t i = 0; i < m_shots.size(); i++) {
+            if (t >= m_shots[i].startS && t < m_shots[i].endS) shotActive = true;
+            if (t >= m_shots[i].startS) shot = &m_shots[i];
+        }
+        m_pumpVoltage = shotActive || steamPulse(t);
+        applyInputs(shotActive);
+
+        bool pumpOn;
+        if (ONLYPID == 1) {
+            pumpOn = shotActive;    // machine's own brew switch runs the pump
+        } else {
+            pumpOn = hw.pinLevel(pinRelayPumpe) == (TRIGGERTYPE ? HIGH : LOW);
+        }
+
+        m_boiler.setHeater(hw.pinLevel(pinRelayHeater) == HIGH);
+        m_boiler.setFlow(pumpOn ? m_options.shotFlowMlS : 0);
+        m_boiler.step(nowUs, dtS);
+        stepGroup(dtS, pumpOn);
+        stepCup(dtS, pumpOn, t, shot);
+        stepPressure(dtS, pumpOn, t);
+        if (pumpOn) m_tankMl -= dtS * m_options.shotFlowMlS;
+        hw.setWaterDistanceMm(WATER_EMPTY - m_tankMl / kTankMl * (WATER_EMPTY - WATER_FULL));
+        hw.setTemperature(0, m_boiler.sensorReadingC());
+        hw.setTemperature(1, m_groupC);
+        hw.setScaleGrams(m_cupGrams);
+    }
+
+    double groupC() const { return m_groupC; }
+    double pressureBar() const { return m_pressureBar; }   // without the pump pulsation
+    double waterLevel() const { return 100 * m_tankMl / kTankMl; }  // % between WATER_EMPTY and WATER_FULL
+
+    std::vector<Shot>& shots() { return m_shots; }
+
+  private:
+    static constexpr double kTankMl = 2000;   // water between WATER_FULL and WATER_EMPTY
+
+    void applyInputs(bool shotActive)
+    {
+        sim::Hardware& hw = sim::Hardware::instance();
+
+        if (ONLYPID == 0) {
+            if (PINBREWSWITCH == 0) {
+                int adc = shotActive ? m_options.switchAdc : 0;
+                if (m_options.switchNoise > 0) adc += lround(m_switchNoise(m_adcRng) * m_options.switchNoise);
+                hw.setAnalogInput(0, std::max(0, std::min(1024, adc)));
+            } else {
+                hw.setDigitalInput(PINBREWSWITCH, shotActive ? HIGH : LOW);
+            }
+        }
+        if (BREWDETECTION == 3 && !m_options.pvsAc) {
+            int on = VOLTAGESENSORTYPE ? HIGH : LOW;
+            hw.setDigitalInput(PINVOLTAGESENSOR, m_pumpVoltage ? on : !on);
+        }
+    }
+
+    // thermoblock steam: the machine pulses the pump on its own, 120 ms every second
+    bool steamPulse(double t) const
+    {
+        const double periodS = 1, pulseS = 0.12;
+        if (m_options.steamS < 0 || t < m_options.steamS || t >= m_options.steamS + m_options.steamLengthS) return false;
+        return fmod(t - m_options.steamS, periodS) < pulseS;
+    }
+
+    // voltage sensor without smoothing: on during the positive half waves
+    // of the pump voltage (49.9 Hz), whatever the step size of the plant
+    void scheduleHalfWave(uint64_t atUs)
+    {
+        const double mainsHz = 49.9;
+        const uint64_t halfUs = (uint64_t)(500000 / mainsHz);
+        sim::Hardware::instance().schedule(atUs, [this, atUs, halfUs]() {
+            bool positive = (atUs / halfUs) % 2 == 0;
+            int on = VOLTAGESENSORTYPE ? HIGH : LOW;
+            sim::Hardware::instance().setDigitalInput(PINVOLTAGESENSOR, m_pumpVoltage && positive ? on : !on);
+            scheduleHalfWave(atUs + halfUs);
+        });
+    }
+
+    // group head: warmed by the boiler, faster by the water of a shot, loses to ambient
+    void stepGroup(double dtS, bool pumpOn)
+    {
+        const double boilerTauS = 150, shotTauS = 20, lossTauS = 600;
+        double boilerC = m_boiler.boilerC();
+        double dT = (boilerC - m_groupC) / boilerTauS - (m_groupC - m_options.boiler.ambientC) / lossTauS;
+        if (pumpOn) dT += (boilerC - m_groupC) / shotTauS;
+        m_groupC += dtS * dT;
+    }
+
+    // cup on the scale: the puck passes the pump flow on with a lag,
+    // it keeps dripping after the pump stopped (flow * tau grams)
+    void stepCup(double dtS, bool pumpOn, double t, Shot* shot)
+    {
+        const double puckTauS = 1.5;
+        const double stopGrams = WEIGHTSETPOINT - 2.5;   // scaleDelayValue
+        m_cupFlow += dtS / puckTauS * ((pumpOn ? m_options.shotFlowMlS : 0) - m_cupFlow);
+        m_cupGrams += dtS * m_cupFlow;
+        if (!shot) return;
+        if (t - shot->startS < dtS) shot->startGrams = m_cupGrams;
+        if (shot->crossS < 0 && m_cupGrams - shot->startGrams >= stopGrams) shot->crossS = t;
+        if (shot->crossS >= 0 && shot->pumpOffS < 0 && !pumpOn) shot->pumpOffS = t;
+        shot->finalGrams = m_cupGrams - shot->startGrams;
+    }
+
+    // brew pressure: builds up against the puck, the vibratory pump
+    // pulses at mains frequency (49.9 Hz, so it drifts against any
+    // sampling clock); the sensor gives 0.5..4.5 V over 0..MAXPRESSURE psi
+    void stepPressure(double dtS, bool pumpOn, double t)
+    {
+        const double brewBar = 9, riseTauS = 1.5, fallTauS = 0.5, mainsHz = 49.9;
+        m_pressureBar += dtS / (pumpOn ? riseTauS : fallTauS) * ((pumpOn ? brewBar : 0) - m_pressureBar);
+        if (PRESSURESENSOR != 1 || PINPRESSURESENSOR >= sim::Hardware::numPins) return;
+        double bar = m_pressureBar;
+        if (pumpOn) bar += m_options.pumpRippleBar * sin(2 * M_PI * mainsHz * t);
+        double adc = OFFSET + bar / (MAXPRESSURE * 0.0689476) * (FULLSCALE - OFFSET) + m_adcNoise(m_adcRng);
+        sim::Hardware::instance().setAnalogInput(PINPRESSURESENSOR, std::max(0, std::min(1023, (int)lround(adc))));
+    }
+
+    const Options& m_options;
+    BoilerModel& m_boiler;
+    double m_groupC;
+    double m_cupFlow;       // ml/s into the cup
+    double m_cupGrams;
+    double m_pressureBar;
+    std::mt19937 m_adcRng;
+    std::normal_distribution<double> m_adcNoise;   // LSB
+    std::normal_distribution<double> m_switchNoise;
+    double m_tankMl;
+    bool m_pumpVoltage;     // pump powered, by the brew switch or the steam pulses
+    std::vector<Shot> m_shots;
+};
+
+/********************************************************
+  Command line
+******************************************************/
+void usage()
+{
+    printf(
+        "usage: ranciliosim [options]\n"
+        "  --duration <s>         simulated time (default 14400)\n"
+        "  --loop-us <us>         simulated time per loop() pass (default 1000)\n"
+        "  --shots <n>            number of shots (default 8)\n"
+        "  --first-shot <s>       first shot after power on (default 1800)\n"
+        "  --shot-interval <s>    time between shots (default 900)\n"
+        "  --shot-length <s>      pump/brew switch on time (default 30)\n"
+        "  --flow <ml/s>          water drawn while the pump runs (default 2.0)\n"
+        "  --heater <W>           heater power (default 1000)\n"
+        "  --boiler-cap <J/K>     heat capacity of boiler and water (default 1700)\n"
+        "  --loss <W/K>           heat loss to ambient (default 0.9)\n"
+        "  --ambient <C>          ambient temperature (default 20)\n"
+        "  --inlet <C>            refill water temperature (default 20)\n"
+        "  --sensor-tau <s>       sensor time constant (default 5)\n"
+        "  --noise <C>            sensor noise, standard deviation (default 0.02)\n"
+        "  --seed <n>             noise seed (default 1)\n"
+        "  --band <C>             setpoint band for heat-up/recovery (default 0.5)\n"
+        "  --autotune-at <s>      request the PID autotune at this time (Blynk V41)\n"
+        "  --online               WiFi, Blynk and MQTT reachable (needs OFFLINEMODUS 0)\n"
+        "  --outage <s>:<s>       WiFi down from, for (with --online)\n"
+        "  --server-outage <s>:<s>  Blynk and MQTT server down from, for (with --online)\n"
+        "  --ds18b20 <n>          DS18B20 on the bus with TEMPSENSOR 1, #1 on the group head (default 1)\n"
+        "  --scale-sps <n>        HX711 samples per second, 10 or 80 (default 10)\n"
+        "  --pump-ripple <bar>    pressure pulsation of the pump, amplitude (default 0.8)\n"
+        "  --pvs-ac               voltage sensor passes the 50 Hz half waves (BREWDETECTION 3)\n"
+        "  --switch-adc <n>:<sd>  analog brew switch reading when closed, noise (default 1024:0)\n"
+        "  --steam <s>:<s>        steam from, for: pump pulses 120 ms every second (QuickMill)\n"
+        "  --csv <file>           write a trace\n"
+        "  --csv-interval <ms>    trace interval (default 1000)\n"
+        "  --cmd <name>           run a debug console command at the end\n"
+        "  --verbose              print the sketch's debug output\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& o)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        const char* v = hasValue ? argv[i + 1] : "";
+
+        if (a == "--verbose") { sim::setLogEnabled(true); continue; }
+        if (a == "--online") { o.online = true; continue; }
+        if (a == "--pvs-ac") { o.pvsAc = true; continue; }
+        if (a == "--help" || !hasValue) return false;
+
+        if (a == "--duration") o.durationS = atof(v);
+        else if (a == "--loop-us") o.loopUs = strtoul(v, NULL, 10);
+        else if (a == "--shots") o.shots = atoi(v);
+        else if (a == "--first-shot") o.firstShotS = atof(v);
+        else if (a == "--shot-interval") o.shotIntervalS = atof(v);
+        else if (a == "--shot-length") o.shotS = atof(v);
+        else if (a == "--flow") o.shotFlowMlS = atof(v);
+        else if (a == "--heater") o.boiler.heaterPowerW = atof(v);
+        else if (a == "--boiler-cap") o.boiler.boilerCapJK = atof(v);
+        else if (a == "--loss") o.boiler.lossWK = atof(v);
+        else if (a == "--ambient") o.boiler.ambientC = o.boiler.startC = atof(v);
+        else if (a == "--inlet") o.boiler.inletC = atof(v);
+        else if (a == "--sensor-tau") o.boiler.sensorTauS = atof(v);
+        else if (a == "--noise") o.boiler.sensorNoiseC = atof(v);
+        else if (a == "--seed") o.boiler.seed = strtoull(v, NULL, 10);
+        else if (a == "--band") o.band = atof(v);
+        else if (a == "--autotune-at") o.autotuneAtS = atof(v);
+        else if (a == "--outage") { if (sscanf(v, "%lf:%lf", &o.outageS, &o.outageLengthS) != 2) return false; }
+        else if (a == "--server-outage") {
+            if (sscanf(v, "%lf:%lf", &o.serverOutageS, &o.serverOutageLengthS) != 2) return false;
+        }
+        else if (a == "--ds18b20") o.ds18b20 = atoi(v);
+        else if (a == "--scale-sps") o.scaleSps = strtoul(v, NULL, 10);
+        else if (a == "--pump-ripple") o.pumpRippleBar = atof(v);
+        else if (a == "--switch-adc") { if (sscanf(v, "%d:%lf", &o.switchAdc, &o.switchNoise) != 2) return false; }
+        else if (a == "--steam") { if (sscanf(v, "%lf:%lf", &o.steamS, &o.steamLengthS) != 2) return false; }
+        else if (a == "--csv") o.csvPath = v;
+        else if (a == "--csv-interval") o.csvIntervalMs = strtoul(v, NULL, 10);
+        else if (a == "--cmd") o.commands.push_back(v);
+        else return false;
+        i++;
+    }
+    return o.loopUs > 0 && o.durationS > 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    sim::Hardware& hw = sim::Hardware::instance();
+    BoilerModel boiler(options.boiler);
+    Rig rig(options, boiler);
+    hw.setPlant(&rig);
+    WiFi.simSetOnline(options.online);
+    DallasTemperature::simSetDevices(options.ds18b20);
+    HX711_ADC::simSps() = options.scaleSps;
+
+    FILE* csv = NULL;
+    if (!options.csvPath.empty()) {
+        csv = fopen(options.csvPath.c_str(), "w");
+        if (!csv) {
+            perror(options.csvPath.c_str());
+            return 1;
+        }
+        fprintf(csv, "t_s,boiler_c,sensor_c,input_c,output,setpoint_c,machinestate,heater,flow_mls,group_c\n");
+    }
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    setup();
+
+    const uint64_t endUs = (uint64_t)(options.durationS * 1e6);
+    const uint64_t sampleUs = 100000;
+    uint64_t nextSampleUs = 0;
+    uint64_t nextCsvUs = 0;
+
+    double heatUpS = -1;
+    double overshoot = 0;
+    RunningStats steadyError, steadyBoiler, steadyGroup, loopNs;
+    uint64_t loopMaxNs = 0;
+    uint64_t blockedUs = 0, blockedMaxUs = 0;
+    bool autotuneRequested = false;
+    int lastState = -1;
+    unsigned long falseBrews = 0;
+    double idleRateMin = 0;   // lowest heat rate without a shot, against BREWDETECTIONLIMIT
+    unsigned long switchChanges = 0;
+    bool lastSwitch = false;
+    double steamOnS = -1, steamOffS = -1;  // SteamON during --steam
+    unsigned long steamStarts = 0, falseSteams = 0;
+    bool lastSteam = false;
+    double autotuneStartS = -1, autotuneEndS = -1;
+    RunningStats pressureError, pressureSteadyError, waterError;
+    double lastPressure = 0;
+    unsigned long pressureChanges = 0;
+
+    while (hw.micros() < endUs) {
+        uint64_t simStart = hw.micros();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        loop();
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        loopNs.add(ns);
+        if (ns > loopMaxNs) loopMaxNs = ns;
+
+        // simulated time spent inside loop() (delay(), blocking drivers)
+        uint64_t blocked = hw.micros() - simStart;
+        blockedUs += blocked;
+        if (blocked > blockedMaxUs) blockedMaxUs = blocked;
+
+        hw.advance(options.loopUs);
+
+        uint64_t now = hw.micros();
+        if (PRESSURESENSOR == 1) {
+            // against the pressure without pulsation, over the whole shot
+            // and after the build-up (shot start + 5 s)
+            std::vector<Shot>& shots = rig.shots();
+            double t = now / 1e6;
+            for (size_t i = 0; i < shots.size(); i++) {
+                if (t < shots[i].startS || t >= shots[i].endS) continue;
+                double err = probe::pressure() - rig.pressureBar();
+                pressureError.add(err);
+                if (t >= shots[i].startS + 5) pressureSteadyError.add(err);
+            }
+            if (probe::pressure() != lastPressure) pressureChanges++;
+            lastPressure = probe::pressure();
+        }
+        if (ONLYPID == 0 && PINBREWSWITCH == 0) {
+            // the analog brew switch as the sketch sees it
+            bool on = probe::brewSwitch();
+            std::vector<Shot>& shots = rig.shots();
+            double t = now / 1e6;
+            if (on != lastSwitch) {
+                switchChanges++;
+                for (size_t i = 0; i < shots.size(); i++) {
+                    if (t < shots[i].startS) break;
+                    if (on && shots[i].switchOnS < 0) shots[i].switchOnS = t;
+                    if (!on && t >= shots[i].endS && shots[i].switchOffS < 0) shots[i].switchOffS = t;
+                }
+            }
+            lastSwitch = on;
+        }
+        if (options.online) {
+            double t = now / 1e6;
+            bool down = t >= options.outageS && t < options.outageS + options.outageLengthS;
+            if (down == WiFi.simOnline()) WiFi.simSetOnline(!down);
+            WiFi.simSetServersOnline(!(t >= options.serverOutageS &&
+                                       t < options.serverOutageS + options.serverOutageLengthS));
+        }
+
+        if (now < nextSampleUs) continue;
+        nextSampleUs += sampleUs;
+
+        double t = now / 1e6;
+        double sp = probe::brewSetPoint();
+        double input = probe::input();
+
+        if (options.autotuneAtS >= 0 && !autotuneRequested && t >= options.autotuneAtS) {
+            probe::startAutotune();
+            autotuneRequested = true;
+        }
+        bool autotuneActive = probe::machineState() == 60;  // kAutotune
+        if (autotuneActive && autotuneStartS < 0) autotuneStartS = t;
+        if (autotuneActive) autotuneEndS = t;
+
+        if (heatUpS < 0 && input >= sp - options.band) heatUpS = t;
+        if (TOF == 1 && t > 30) waterError.add(probe::waterLevel() - rig.waterLevel());
+
+        bool inShotWindow = false;
+        std::vector<Shot>& shots = rig.shots();
+        for (size_t i = 0; i < shots.size(); i++) {
+            Shot& s = shots[i];
+            if (t < s.startS || t > s.startS + options.recoveryWindowS) continue;
+            inShotWindow = true;
+            if (boiler.boilerC() < s.minBoilerC) s.minBoilerC = boiler.boilerC();
+            if (input < s.minInput) s.minInput = input;
+            if (fabs(input - sp) > options.band) s.lastOutOfBandS = t;
+            if (s.detectedS < 0 && probe::machineState() == 30) s.detectedS = t;
+        }
+
+        // brew state without a shot (software brew detection)
+        int state = probe::machineState();
+        if (state == 30 && lastState != 30 && !inShotWindow) falseBrews++;
+        if (!inShotWindow && !autotuneActive && heatUpS >= 0 && t > heatUpS + 120 &&
+            probe::heatRate() < idleRateMin)
+            idleRateMin = probe::heatRate();
+        lastState = state;
+
+        // SteamON from the pump pulses (QuickMill), or wrongly from a shot
+        bool steam = probe::steamOn();
+        bool inSteamWindow = options.steamS >= 0 && t >= options.steamS &&
+                             t < options.steamS + options.steamLengthS + 10;
+        if (steam && !lastSteam) {
+            if (inSteamWindow) steamStarts++;
+            else falseSteams++;
+            if (inSteamWindow && steamOnS < 0) steamOnS = t;
+        }
+        if (!steam && lastSteam && inSteamWindow) steamOffS = t;
+        lastSteam = steam;
+
+        // the relay experiment and its settling time are no steady state
+        bool inAutotuneWindow = autotuneStartS >= 0 && t < autotuneEndS + options.settleS;
+
+        if (heatUpS >= 0 && !inShotWindow && !inAutotuneWindow) {
+            if (shots.empty() || t < shots[0].startS) {
+                if (input - sp > overshoot) overshoot = input - sp;
+            }
+            if (t > heatUpS + options.settleS) {
+                steadyError.add(input - sp);
+                steadyBoiler.add(boiler.boilerC());
+                steadyGroup.add(rig.groupC());
+            }
+        }
+
+        if (csv && now >= nextCsvUs) {
+            nextCsvUs += (uint64_t)options.csvIntervalMs * 1000;
+            fprintf(csv, "%.1f,%.3f,%.3f,%.2f,%.1f,%.1f,%d,%d,%.2f,%.3f\n",
+                    t, boiler.boilerC(), boiler.sensorReadingC(), input, probe::output(),
+                    probe::setPoint(), probe::machineState(), boiler.heaterOn() ? 1 : 0, boiler.flowMlS(),
+                    rig.groupC());
+        }
+    }
+
+    double wallS = std::chrono::duration_cast<std::chrono::duration<double> >(
+        std::chrono::steady_clock::now() - wallStart).count();
+
+    if (csv) fclose(csv);
+
+    for (size_t i = 0; i < options.commands.size(); i++) {
+        if (!sim::debugRunCommand(options.commands[i].c_str())) {
+            printf("unknown debug command: %s\n", options.commands[i].c_str());
+        }
+    }
+
+    /********************************************************
+      Report
+    ******************************************************/
+    double simS = hw.micros() / 1e6;
+    double sp = probe::brewSetPoint();
+
+    printf("simulated %.0f s in %.2f s (%.0fx real time), loop pass %lu us\n",
+           simS, wallS, simS / wallS, options.loopUs);
+    if (heatUpS >= 0) {
+        printf("heat-up:      %.1f s to %.1f C (band %.1f), overshoot %.2f C\n",
+               heatUpS, sp - options.band, options.band, overshoot);
+    } else {
+        printf("heat-up:      setpoint not reached, Input %.2f C\n", probe::input());
+    }
+    if (steadyError.n) {
+        printf("steady state: Input err mean %+.3f rms %.3f p-p %.3f C, boiler p-p %.3f C\n",
+               steadyError.mean(), steadyError.rms(), steadyError.max - steadyError.min,
+               steadyBoiler.max - steadyBoiler.min);
+        printf("group head:   mean %.2f p-p %.3f C\n", steadyGroup.mean(), steadyGroup.max - steadyGroup.min);
+    }
+
+    std::vector<Shot>& shots = rig.shots();
+    RunningStats dip, inputDip, recovery, detection, cupGrams, stopLatency, switchOn, switchOff;
+    for (size_t i = 0; i < shots.size(); i++) {
+        if (shots[i].startS + options.recoveryWindowS > simS) continue;
+        dip.add(sp - shots[i].minBoilerC);
+        inputDip.add(sp - shots[i].minInput);
+        recovery.add(shots[i].lastOutOfBandS - shots[i].startS);
+        if (shots[i].detectedS >= 0) detection.add(shots[i].detectedS - shots[i].startS);
+        if (shots[i].switchOnS >= 0) switchOn.add(shots[i].switchOnS - shots[i].startS);
+        if (shots[i].switchOffS >= 0) switchOff.add(shots[i].switchOffS - shots[i].endS);
+        if (BREWMODE == 2 && ONLYPID == 0) {
+            cupGrams.add(shots[i].finalGrams);
+            if (shots[i].pumpOffS >= 0) stopLatency.add(shots[i].pumpOffS - shots[i].crossS);
+        }
+    }
+    if (dip.n) {
+        printf("shots:        %lu, boiler dip mean %.2f max %.2f C, Input dip mean %.2f C, "
+               "recovery mean %.1f max %.1f s\n",
+               dip.n, dip.mean(), dip.max, inputDip.mean(), recovery.mean(), recovery.max);
+    }
+    if (autotuneRequested) {
+        probe::Gains g = probe::gains();
+        if (autotuneStartS >= 0) {
+            printf("autotune:     %.0f s to %.0f s, ", autotuneStartS, autotuneEndS);
+        } else {
+            printf("autotune:     not started, ");
+        }
+        printf("Kp %.1f Tn %.1f Tv %.1f, start Kp %.1f Tn %.1f, BD Kp %.1f Tn %.1f Tv %.1f\n",
+               g.aggKp, g.aggTn, g.aggTv, g.startKp, g.startTn, g.aggbKp, g.aggbTn, g.aggbTv);
+    }
+    if (dip.n) {
+        printf("brew detect:  %lu of %lu shots, latency mean %.1f max %.1f s, %lu without shot, "
+               "idle rate min %.0f (limit -%d)\n",
+               detection.n, dip.n, detection.mean(), detection.n ? detection.max : 0.0, falseBrews,
+               idleRateMin, BREWDETECTIONLIMIT);
+    }
+    if (ONLYPID == 0 && PINBREWSWITCH == 0 && dip.n) {
+        printf("brew switch:  %lu changes for %lu shots, on after %.0f ms, off after %.0f ms, "
+               "%.0f ADC reads/s\n",
+               switchChanges, dip.n, switchOn.mean() * 1000, switchOff.mean() * 1000, hw.analogReads() / simS);
+    }
+    if (options.steamS >= 0 || falseSteams) {
+        printf("steam:        ");
+        if (steamOnS >= 0) printf("on %.1f s after the first pulse, ", steamOnS - options.steamS);
+        else if (options.steamS >= 0) printf("not detected, ");
+        if (steamOffS >= 0 && !lastSteam) {
+            printf("off %.1f s after the last pulse, ", steamOffS - (options.steamS + options.steamLengthS));
+        }
+        printf("%lu starts, %lu without steam\n", steamStarts, falseSteams);
+    }
+    if (cupGrams.n) {
+        printf("brew weight:  %lu shots, cup mean %.2f g (set %.1f) min %.2f max %.2f g, "
+               "pump stop latency mean %.0f max %.0f ms\n",
+               cupGrams.n, cupGrams.mean(), (double)WEIGHTSETPOINT, cupGrams.min, cupGrams.max,
+               stopLatency.mean() * 1000, stopLatency.n ? stopLatency.max * 1000 : 0.0);
+    }
+    if (waterError.n) {
+        printf("water level:  err mean %+.2f rms %.2f max %.2f %%, tank %.1f %% at the end\n",
+               waterError.mean(), waterError.rms(), std::max(-waterError.min, waterError.max), rig.waterLevel());
+    }
+    if (pressureError.n) {
+        printf("pressure:     during shots err rms %.3f max %.3f bar, after build-up mean %+.3f rms %.3f bar, "
+               "%.1f updates/s\n",
+               pressureError.rms(), std::max(-pressureError.min, pressureError.max), pressureSteadyError.mean(),
+               pressureSteadyError.rms(), pressureChanges / simS);
+    }
+    printf("heater:       duty %.1f %%, energy %.1f Wh\n",
+           100 * boiler.heaterEnergyJ() / (options.boiler.heaterPowerW * simS), boiler.heaterEnergyJ() / 3600);
+
+    const sim::IsrStats& isr = hw.timer1Stats();
+    printf("host cpu:     loop() avg %.0f max %llu ns, timer ISR avg %.0f p99 %llu p99.9 %llu max %llu ns (%lu calls)\n",
+           loopNs.mean(), (unsigned long long)loopMaxNs,
+           isr.calls ? (double)isr.totalNs / isr.calls : 0.0, (unsigned long long)isr.percentileNs(99),
+           (unsigned long long)isr.percentileNs(99.9), (unsigned long long)isr.maxNs, isr.calls);
+    printf("blocking:     loop() blocked %.1f s in total, longest pass %.1f ms\n",
+           blockedUs / 1e6, blockedMaxUs / 1e3);
+    printf("eeprom:       %lu commits\n", EEPROM.commits());
+    if (options.online) {
+        printf("network:      %lu packets, %lu bytes (%.1f packets/min)\n",
+               WiFiClient::simPackets, WiFiClient::simBytes, WiFiClient::simPackets / (simS / 60));
+        if (MQTT == 1) {
+            printf("mqtt:         %lu publishes, %lu bytes (%.1f publishes, %.0f bytes/min)\n",
+                   probe::mqttPublishes(), probe::mqttBytes(), probe::mqttPublishes() / (simS / 60),
+                   probe::mqttBytes() / (simS / 60));
+        }
+    }
+
+    return 0;
+}
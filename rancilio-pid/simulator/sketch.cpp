@@ -0,0 +1,40 @@
+/********************************************************
+  The unmodified sketch as one host translation unit.
+  The Makefile copies the sketch directory (without a
+  user's userConfig.h) to the build directory first.
+******************************************************/
+
+#include "SketchPrototypes.h"
+#include "rancilio-pid.ino"
+
+#include "SketchProbe.h"
+
+namespace probe {
+double input() { return Input; }
+double output() { return Output; }
+double setPoint() { return ::setPoint; }
+double brewSetPoint() { return BrewSetPoint; }
+int machineState() { return machinestate; }
+bool steamOn() { return SteamON == 1; }
+double heatRate() { return heatrateaverage; }
+bool brewSwitch() { return brewswitch == HIGH; }
+unsigned long mqttPublishes() { return mqtt.simPublishes(); }
+unsigned long mqttBytes() { return mqtt.simBytes(); }
+double waterLevel() { return percentage; }
+#if (PRESSURESENSOR == 1)
+double pressure() { return inputPressure; }
+#else
+double pressure() { return 0; }
+#endif
+double kp() { return bPID.GetKp(); }
+double ki() { return bPID.GetKi(); }
+double kd() { return bPID.GetKd(); }
+
+Gains gains()
+{
+    Gains g = { aggKp, aggTn, aggTv, startKp, startTn, aggbKp, aggbTn, aggbTv };
+    return g;
+}
+
+void startAutotune() { autotuneON = 1; }
+}
@@ -0,0 +1,262 @@
+/********************************************************
+  Version 2.9.4 (07.01.2022)
+  userConfig for the host simulator
+
+  Same settings as userConfig_sample.h, but offline, no
+  display and no TOF. Every value can be overridden from
+  the make command line, e.g.
+    make SIMDEFS="-DONLYPID=0 -DAGGKP=60"
+******************************************************/
+
+#ifndef _userConfig_H
+#define _userConfig_H
+
+#define SYSVERSION '2.9.4 MASTER'
+
+// List of supported machines
+enum MACHINE {
+  // USED AS INDEX (see machineName[])!
+  RancilioSilvia = 0,   // MACHINEID 0
+  RancilioSilviaE,      // MACHINEID 1
+  Gaggia,               // MACHINEID 2
+  QuickMill             // MACHINEID 3
+};
+
+#ifndef MACHINEID
+#define MACHINEID 0
+#endif
+
+// Display (not simulated)
+#define DISPLAY 0
+#define OLED_I2C 0x3C
+#define DISPLAYTEMPLATE 3
+#define DISPLAYROTATE U8G2_R0
+#define SHOTTIMER 1
+#define HEATINGLOGO 0
+#define OFFLINEGLOGO 1
+#ifndef BREWSWITCHDELAY
+#define BREWSWITCHDELAY 3000
+#endif
+#define LANGUAGE 1
+
+// Offline mode
+#ifndef OFFLINEMODUS
+#define OFFLINEMODUS 1
+#endif
+#define FALLBACK 0
+#define GRAFANA 1
+
+// PID & Hardware
+#ifndef ONLYPID
+#define ONLYPID 1
+#endif
+#define ONLYPIDSCALE 0
+#ifndef BREWMODE
+#define BREWMODE 1
+#endif
+#ifndef BREWDETECTION
+#define BREWDETECTION 1
+#endif
+#define BREWSWITCHTYPE 1
+#define COLDSTART_PID 1
+#define TRIGGERTYPE HIGH
+#define VOLTAGESENSORTYPE HIGH
+#define PINMODEVOLTAGESENSOR INPUT
+#ifndef PRESSURESENSOR
+#define PRESSURESENSOR 0
+#endif
+#ifndef PID_FIXEDPOINT
+#define PID_FIXEDPOINT 0
+#endif
+#ifndef FEEDFORWARD
+#define FEEDFORWARD 0
+#endif
+#define HEATERPOWER 1000
+#define BREWFLOW 2.0
+#define INLETTEMP 20
+#ifndef FEEDFORWARDTIME
+#define FEEDFORWARDTIME 30
+#endif
+#ifndef HEATERPWMMODE
+#define HEATERPWMMODE 0
+#endif
+#ifndef TEMPOBSERVER
+#define TEMPOBSERVER 0
+#endif
+#define BOILERCAPACITY 1700
+#define BOILERLOSS 0.9
+#define SENSORTAU 5
+#ifndef HEATERTICK
+#define HEATERTICK 20
+#endif
+
+// TOF sensor for water level
+#ifndef TOF
+#define TOF 0
+#endif
+#define TOF_I2C 0x29
+#define CALIBRATION_MODE 0
+#define WATER_FULL 102
+#define WATER_EMPTY 205
+
+// E-Trigger
+#define ETRIGGER 0
+#define ETRIGGERTIME 600
+#define TRIGGERRELAYTYPE HIGH
+
+//Weight SCALE
+#ifndef WEIGHTSETPOINT
+#define WEIGHTSETPOINT 30
+#endif
+
+//Pressure sensor
+#define OFFSET      102
+#define FULLSCALE   922
+#define MAXPRESSURE 200
+
+/// Wifi
+#define HOSTNAME "simulator"
+#define D_SSID "simssid"
+#define PASS "simpass"
+#define MAXWIFIRECONNECTS 5
+#define WIFICINNECTIONDELAY 10000
+#ifndef PROFILER
+#define PROFILER 0
+#endif
+#define DEBUGMETHOD 1              // SerialDebug, printed with --verbose
+#define MAXLOGLINES 100
+
+// OTA
+#define OTA false
+#define OTAHOST "simulator"
+#define OTAPASS "otapass"
+
+// MQTT
+#ifndef MQTT
+#define MQTT 0
+#endif
+#define MQTT_USERNAME "mymqttuser"
+#define MQTT_PASSWORD "mymqttpass"
+#define MQTT_TOPIC_PREFIX "custom/Küche."
+#define MQTT_SERVER_IP "127.0.0.1"
+#define MQTT_SERVER_PORT 1883
+#ifndef TELEMETRYDEADBAND
+#define TELEMETRYDEADBAND 1
+#endif
+#define TELEMETRYHEARTBEAT 60
+#ifndef MQTT_BATCH
+#define MQTT_BATCH 0
+#endif
+
+// BLynk
+#define AUTH "blynk_auth"
+#define BLYNKADDRESS "127.0.0.1"
+#define BLYNKPORT 8080
+
+// PID - offline values
+#ifndef SETPOINT
+#define SETPOINT 95
+#endif
+#ifndef STEAMSETPOINT
+#define STEAMSETPOINT 120
+#endif
+#ifndef BREWDETECTIONLIMIT
+#define BREWDETECTIONLIMIT 150
+#endif
+#ifndef BREWDETECTIONWINDOW
+#define BREWDETECTIONWINDOW 15
+#endif
+#ifndef AGGKP
+#define AGGKP 69
+#endif
+#ifndef AGGTN
+#define AGGTN 399
+#endif
+#ifndef AGGTV
+#define AGGTV 0
+#endif
+
+// PID coldstart
+#ifndef STARTKP
+#define STARTKP 50
+#endif
+#ifndef STARTTN
+#define STARTTN 150
+#endif
+
+// PID - offline brewdetection values
+#ifndef AGGBKP
+#define AGGBKP 50
+#endif
+#ifndef AGGBTN
+#define AGGBTN 0
+#endif
+#ifndef AGGBTV
+#define AGGBTV 20
+#endif
+
+// PID autotune
+#ifndef AUTOTUNE_OUTPUT
+#define AUTOTUNE_OUTPUT 300
+#endif
+#define AUTOTUNE_HYSTERESIS 0.2
+
+// Backflush values
+#define FILLTIME 3000
+#define FLUSHTIME 6000
+#define MAXFLUSHCYCLES 5
+
+// Pin Layout
+#ifndef ONE_WIRE_BUS
+#define ONE_WIRE_BUS 2             // 16 = TSIC library instead of ZACwire
+#endif
+#define PINBREWSWITCH 0
+#ifndef PINPRESSURESENSOR
+#define PINPRESSURESENSOR 99
+#endif
+#define pinRelayVentil 12
+#define pinRelayPumpe 13
+#define pinRelayHeater 14
+#define PINVOLTAGESENSOR  15
+#define PINETRIGGER 16
+#define STEAMONPIN 17
+#define OLED_SCL 5
+#define OLED_SDA 4
+#ifndef HXDATPIN
+#define HXDATPIN 99
+#define HXCLKPIN 99
+#endif
+#ifndef SCALEINTERRUPT
+#define SCALEINTERRUPT 0
+#endif
+#ifndef SCALESAMPLES
+#define SCALESAMPLES 16
+#endif
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+
+// Historic (no settings)
+#define PONE 1
+#ifndef TEMPSENSOR
+#define TEMPSENSOR 2
+#endif
+#ifndef DS18B20RESOLUTION
+#define DS18B20RESOLUTION 10
+#endif
+#ifndef TEMPSENSORS
+#define TEMPSENSORS 1
+#endif
+#ifndef SENSORFILTERWINDOW
+#define SENSORFILTERWINDOW 7
+#endif
+#ifndef SENSORFILTERLIMIT
+#define SENSORFILTERLIMIT 3
+#endif
+#ifndef SENSORSTUCKTIME
+#define SENSORSTUCKTIME 300
+#endif
+#ifndef TEMPSENSORWEIGHTS
+#define TEMPSENSORWEIGHTS {1}
+#endif
+
+#endif // _userConfig_H